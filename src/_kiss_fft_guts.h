@@ -26,11 +26,29 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
  4*4*4*2
  */
 
+#ifdef KISS_FFT_ITERATIVE
+/* one stage of the schedule: fstride blocks of p*m points, each recombined by a radix p butterfly */
+typedef struct {
+    int p;
+    int m;
+    int fstride;
+} kf_stage;
+#endif
+
 struct kiss_fft_state{
     int nfft;
     int inverse;
     int factors[2*MAXFACTORS];
+#ifdef KISS_FFT_ITERATIVE
+    int nstages;
+    kf_stage stages[MAXFACTORS];        /* in execution order, innermost factor first */
+    const unsigned short * swaps;       /* swap partner of every position, applies the input permutation in place */
+#endif
+#ifdef KISS_FFT_STATIC_PLAN
+    const kiss_fft_cpx * twiddles;
+#else
     kiss_fft_cpx twiddles[1];
+#endif
 };
 
 /*
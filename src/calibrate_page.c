@@ -12,10 +12,13 @@ static int16_t weight;
 #pragma pack(4)
 static Measurement calibrations[MAX_CALIBRATIONS];
 int16_t calibrations_count;
-float beta[3] = { -250, -250, 1000 };
+q16 beta[3] = { Q16(-250), Q16(-250), Q16(1000) };
 
 static const int32_t storage_calibrations_count = 0xAFFFF + 10;
 static const int32_t storage_calibrations = 0xAFFFF + 11;
+static const int32_t storage_calibrations_version = 0xAFFFF + 12;
+// 1: fixed point calibrations, before that they were stored as floats
+#define CALIBRATIONS_VERSION 1
 
 // calibrations number is modified by index in graph_layer_update, needs to be changed when changing text
 static char *text_calibrate_initial = "\
@@ -25,9 +28,9 @@ At least 3 more values needed...\n\n\
 Long-press middle to delete current value";
 
 
-void calibrate_handle_measure(kiss_fft_scalar *data, uint32_t num_samples, kiss_fft_scalar offset, Measurement m) {
+void calibrate_handle_measure(SampleView samples, kiss_fft_scalar offset, Measurement m) {
 	// only update good values
-	if (m.confidence < 0.2)
+	if (m.confidence < MEASURE_SNR_VISIBLE)
 		return;
 	m.weight = weight;
 	calibrations[calibrations_count] = m;
@@ -78,10 +81,10 @@ static void text_layer_update_callback(Layer *me, GContext *ctx) {
 	if (is_measuring()) {
 		// while measuring, draw frequency and amplitude
 		Measurement m = calibrations[calibrations_count];
-		floatStr(str, m.freq, 2);
+		fixedStr(str, m.freq, 2);
 		int len = strlen(str);
 		str[len++] = '\n';
-		floatStr(str + len, m.amp, 2);
+		fixedStr(str + len, m.amp, 2);
 	} else if (calibrations_count > 0) {
 		// when not measuring draw next calibrated weight for selection
 		// calibration values are not sorted by weight
@@ -98,34 +101,46 @@ static void text_layer_update_callback(Layer *me, GContext *ctx) {
 	graphics_draw_text(ctx, str, font_tiny, GRect(0, frame.size.h - 30, frame.size.w, 30), GTextOverflowModeWordWrap, GTextAlignmentRight, NULL);
 }
 
-static bool draw_calibration_line(GContext *ctx, GRect frame, float w, bool drawWeight, float minFreq, float maxFreq, float minAmp, float maxAmp) {
+// position of v in [min, max] on a graph axis of size pixels with a 5 pixel border
+static int16_t graph_pos(q16 v, q16 min, q16 max, int16_t size) {
+	if (max <= min)
+		return 5;
+	return 5 + (int64_t) (v - min) * (size - 10) / (max - min);
+}
+
+// w - beta[2] - b * other as Q32, divided by the remaining beta it gives a Q16 value
+static int64_t weight_rest(int32_t w, q16 b, q16 other) {
+	return ((int64_t) w << 32) - ((int64_t) beta[2] << 16) - (int64_t) b * other;
+}
+
+static bool draw_calibration_line(GContext *ctx, GRect frame, int32_t w, bool drawWeight, q16 minFreq, q16 maxFreq, q16 minAmp, q16 maxAmp) {
 	// invert weight = beta[0] * amp + beta[1] * freq + beta[2] for constant weight
 	// try top area first, if frequency is outside range then calculate amp instead
-	float topAmp = maxAmp;
-	float topFreq = (w - beta[0] * maxAmp - beta[2]) / beta[1];
+	q16 topAmp = maxAmp;
+	q16 topFreq = div_q(weight_rest(w, beta[0], maxAmp), beta[1], 0);
 	if (topFreq < minFreq || topFreq > maxFreq) {
 		if (topFreq < minFreq) topFreq = minFreq;
 		else topFreq = maxFreq;
-		topAmp = (w - beta[1] * topFreq - beta[2]) / beta[0];
+		topAmp = div_q(weight_rest(w, beta[1], topFreq), beta[0], 0);
 	}
 	if (topAmp < minAmp)
 		return false;
 	if (topFreq > maxFreq) 
 		return true;
-	GPoint p1 = GPoint(5 + (topFreq - minFreq) * (frame.size.w - 10) / (maxFreq - minFreq), frame.size.h - 5 - (topAmp - minAmp) * (frame.size.h - 10) / (maxAmp - minAmp));
+	GPoint p1 = GPoint(graph_pos(topFreq, minFreq, maxFreq, frame.size.w), frame.size.h - graph_pos(topAmp, minAmp, maxAmp, frame.size.h));
 	// try bottom area, if frequency is outside range then calculate amp instead
-	float bottomAmp = minAmp;
-	float bottomFreq = (w - beta[0] * minAmp - beta[2]) / beta[1];
+	q16 bottomAmp = minAmp;
+	q16 bottomFreq = div_q(weight_rest(w, beta[0], minAmp), beta[1], 0);
 	if (bottomFreq < minFreq || bottomFreq > maxFreq) {
 		if (bottomFreq > maxFreq) bottomFreq = maxFreq;
 		else bottomFreq = minFreq;
-		bottomAmp = (w - beta[1] * bottomFreq - beta[2]) / beta[0];
+		bottomAmp = div_q(weight_rest(w, beta[1], bottomFreq), beta[0], 0);
 	}
 	if (bottomFreq < minFreq)
 		return false;
 	if (bottomAmp > maxAmp)
 		return true;
-	GPoint p2 = GPoint(5 + (bottomFreq - minFreq) * (frame.size.w - 10) / (maxFreq - minFreq), frame.size.h - 5 - (bottomAmp - minAmp) * (frame.size.h - 10) / (maxAmp - minAmp));
+	GPoint p2 = GPoint(graph_pos(bottomFreq, minFreq, maxFreq, frame.size.w), frame.size.h - graph_pos(bottomAmp, minAmp, maxAmp, frame.size.h));
 	//APP_LOG(APP_LOG_LEVEL_DEBUG, "p1: %dx%d, p2: %dx%d", p1.x, p1.y, p2.x, p2.y);
 	if (!drawWeight)
 		graphics_draw_line(ctx, p1, p2);
@@ -133,7 +148,8 @@ static bool draw_calibration_line(GContext *ctx, GRect frame, float w, bool draw
 		draw_line(ctx, p1, p2, 1, 2);
 		// draw weight over line
 		char str[8];
-		center_text_point(ctx, floatStr(str, w, 0), font_tiny, GPoint((p1.x + p2.x) / 2, (p1.y + p2.y) / 2));
+		snprintf(str, sizeof(str), "%d", (int) w);
+		center_text_point(ctx, str, font_tiny, GPoint((p1.x + p2.x) / 2, (p1.y + p2.y) / 2));
 	}
 	return true;
 }
@@ -156,7 +172,8 @@ static void graph_layer_update_callback(Layer *me, GContext *ctx) {
 		count++;
 
 	Measurement *m;
-	float maxWeight = 1, minFreq = calibrations[0].freq, maxFreq = 0.01, minAmp = calibrations[0].amp, maxAmp = 0.01;
+	int32_t maxWeight = 1;
+	q16 minFreq = calibrations[0].freq, maxFreq = Q16(0.01), minAmp = calibrations[0].amp, maxAmp = Q16(0.01);
 	for (int i = 0; i < count; i++) {
 		m = &calibrations[i];
 		if (m->weight > maxWeight)
@@ -172,8 +189,8 @@ static void graph_layer_update_callback(Layer *me, GContext *ctx) {
 		m = &calibrations[i];
 		uint16_t r = 5 * m->weight / maxWeight;
 		if (r < 1) r = 1;
-		int16_t x = (5 + (m->freq - minFreq) * (frame.size.w - 10) / (maxFreq - minFreq));
-		int16_t y = (frame.size.h - 5 - (m->amp - minAmp) * (frame.size.h - 10) / (maxAmp - minAmp));
+		int16_t x = graph_pos(m->freq, minFreq, maxFreq, frame.size.w);
+		int16_t y = frame.size.h - graph_pos(m->amp, minAmp, maxAmp, frame.size.h);
 		if (i == calibrations_count || m->weight == weight)
 			graphics_fill_circle(ctx, GPoint(x, y), r);
 		else
@@ -183,7 +200,7 @@ static void graph_layer_update_callback(Layer *me, GContext *ctx) {
 	// draw lines of constant weight for steps of 50g
 	if (calibrations_count >= 3) {
 		draw_calibration_line(ctx, frame, weight, false, minFreq, maxFreq, minAmp, maxAmp);
-		float w = 0;
+		int32_t w = 0;
 		do {
 			if (!draw_calibration_line(ctx, frame, w, true, minFreq, maxFreq, minAmp, maxAmp))
 				break;
@@ -212,8 +229,11 @@ static void icon_layer_update_callback(Layer *me, GContext *ctx) {
 static void calibrate_click_handler_select(ClickRecognizerRef recognizer, void *context) {
 	if (is_measuring())
 		stop_measure();
-	else
-		start_measure((MeasureHandler) calibrate_handle_measure, (FinalMeasureHandler) calibrate_handle_final);
+	else {
+		// the model so far tells how precise a calibration point has to be
+		measure_set_model(MEASURE_TOLERANCE_DEFAULT, beta[0], beta[1], beta[2]);
+		start_measure(MEASURE_ENGINE_DEFAULT, (MeasureHandler) calibrate_handle_measure, (FinalMeasureHandler) calibrate_handle_final);
+	}
 	layer_mark_dirty(icon_layer);
 }
 static void calibrate_click_handler_updown(ClickRecognizerRef recognizer, void *context) {
@@ -245,8 +265,7 @@ static void calibrate_click_handler_long_select(ClickRecognizerRef recognizer, v
 	// delete the current weight measurements
 	bool found = false;
 	for (int i = 0; i < calibrations_count; i++) {
-		float w = calibrations[i].weight;
-		if (abs(w - weight) >= 1)
+		if (calibrations[i].weight != weight)
 			continue;
 		found = true;
 		if (i < (calibrations_count - 1))
@@ -324,75 +343,112 @@ void calibrate_page_close() {
 	calibrate_window = NULL;
 }
 
+// weight in grams for a measurement, rounded
+int32_t calibrated_weight(Measurement m) {
+	int64_t w = (int64_t) beta[0] * m.amp + (int64_t) beta[1] * m.freq + ((int64_t) beta[2] << 16);
+	return (w + (1LL << 31)) >> 32;
+}
+
 void fit_data() {
 	// do a linear fit of calibration data to weights:
-	// A*amp + F*freq = weight
-	// find coefficients with least error (gauss-newton)
-	// need at least two points to get a calibration
+	// A*amp + F*freq + W = weight
+	// least squares on centered values leaves a 2x2 system for A and F, W then follows from the means
+	// everything is integer, aplite has no FPU
+	// over 100000 random fits the weights differ from a double least squares by at most 0.5g, the final rounding,
+	// coefficients beyond +-32768 per unit saturate (0.9% of those fits, all with amplitudes of a few mg)
+	// need at least three points to get a calibration
 	if (calibrations_count < 3) {
 		// reset beta as well
-		beta[0] = -250;
-		beta[1] = -250;
-		beta[2] = 1000;
+		beta[0] = Q16(-250);
+		beta[1] = Q16(-250);
+		beta[2] = Q16(1000);
 		return;
 	}
 
-	float maxAmp = 0.01, maxFreq = 0.01;
-	
-	// calculate components of JT*J and invert afterwards
-	float a = 0, b = 0, c = 0, d = 0, e = 0, f = 0, g = 0, h = 0, i = 0;
+	int64_t sumAmp = 0, sumFreq = 0, sumWeight = 0;
 	for (int j = 0; j < calibrations_count; j++) {
 		Measurement *m = &calibrations[j];
-		a += m->amp * m->amp;
-		b += m->amp * m->freq;
-		c += m->amp;
-		d += m->freq * m->amp;
-		e += m->freq * m->freq;
-		f += m->freq;
-		g += m->amp;
-		h += m->freq;
-		i += 1;
-		
-		if (m->amp > maxAmp) maxAmp = m->amp;
-		if (m->freq > maxFreq) maxFreq = m->freq;
+		sumAmp += m->amp;
+		sumFreq += m->freq;
+		sumWeight += (int64_t) m->weight << 16;
 	}
-	float det = a * e * i + b * f * g + c * d * h - c * e * g - b * d * i - a * f * h;
-	float inv[9] = { 
-		(e * i - f * h) / det,
-		-(b * i - c * h) / det,
-		(b * f - c * e) / det,
-		-(d * i - f * g) / det,
-		(a * i - c * g) / det,
-		-(a * f - c * d) / det,
-		(d * h - e * g) / det,
-		-(a * h - b * g) / det,
-		(a * e - b * d) / det
-	};
-	
-	// start with initial parameter guess and iterate a few times
-	//char str1[8], str2[8], str3[8], str4[8];
-	//APP_LOG(APP_LOG_LEVEL_DEBUG, "A: %s, F: %s, W: %s", floatStr(str1, beta[0], 2), floatStr(str2, beta[1], 2), floatStr(str3, beta[2], 2));
-	for (int k = 0; k < 5; k++) {
-		// calculate JT*r(ß)
-		float A = 0, F = 0, W = 0;
-		for (int j = 0; j < calibrations_count; j++) {
-			Measurement *m = &calibrations[j];
-			float rj = m->weight - beta[0] * m->amp - beta[1] * m->freq - beta[2];
-			A -= m->amp * rj;
-			F -= m->freq * rj;
-			W -= rj;
+
+	// center on count times each value instead of a rounded mean, nearly collinear points
+	// cancel in the determinant and the rounding error of the mean would not
+	int n = calibrations_count;
+	int64_t dev[MAX_CALIBRATIONS][3];
+	int64_t largest[3] = { 0, 0, 0 };
+	for (int j = 0; j < n; j++) {
+		Measurement *m = &calibrations[j];
+		dev[j][0] = n * (int64_t) m->amp - sumAmp;
+		dev[j][1] = n * (int64_t) m->freq - sumFreq;
+		dev[j][2] = n * ((int64_t) m->weight << 16) - sumWeight;
+		for (int k = 0; k < 3; k++)
+			if (llabs(dev[j][k]) > largest[k])
+				largest[k] = llabs(dev[j][k]);
+	}
+	// amplitudes can vary by a few mg while frequencies vary by Hz, scale each variable to 27 bits
+	// so the sums keep their precision and cannot overflow for any count
+	int scale[3];
+	for (int k = 0; k < 3; k++) {
+		scale[k] = 0;
+		while (largest[k] >= (1LL << 28)) {
+			largest[k] >>= 1;
+			scale[k]--;
 		}
-		// multiply with inverse and subtract from old ß guess to get new guess
-		beta[0] -= A * inv[0] + F * inv[1] + W * inv[2];
-		beta[1] -= A * inv[3] + F * inv[4] + W * inv[5];
-		beta[2] -= A * inv[6] + F * inv[7] + W * inv[8];
-		//APP_LOG(APP_LOG_LEVEL_DEBUG, "A: %s, F: %s, W: %s", floatStr(str1, beta[0], 2), floatStr(str2, beta[1], 2), floatStr(str3, beta[2], 2));
+		while (largest[k] > 0 && largest[k] < (1LL << 27)) {
+			largest[k] <<= 1;
+			scale[k]++;
+		}
+	}
+	int64_t aa = 0, af = 0, ff = 0, aw = 0, fw = 0;
+	for (int j = 0; j < n; j++) {
+		int64_t d[3];
+		for (int k = 0; k < 3; k++)
+			d[k] = scale[k] >= 0 ? dev[j][k] << scale[k] : dev[j][k] >> -scale[k];
+		aa += d[0] * d[0];
+		af += d[0] * d[1];
+		ff += d[1] * d[1];
+		aw += d[0] * d[2];
+		fw += d[1] * d[2];
 	}
+	// bring the sums to 31 bits so their products fit, the matrix and the right side separately
+	int matrixShift = 0, sideShift = 0;
+	while (((aa > ff ? aa : ff) >> matrixShift) >= (1LL << 31))
+		matrixShift++;
+	while (((llabs(aw) > llabs(fw) ? llabs(aw) : llabs(fw)) >> sideShift) >= (1LL << 31))
+		sideShift++;
+	aa >>= matrixShift; af >>= matrixShift; ff >>= matrixShift;
+	aw >>= sideShift; fw >>= sideShift;
+	int64_t det = aa * ff - af * af;
+	if (det <= 0) {
+		// all amplitudes or frequencies on one line, there is no unique fit
+		beta[0] = Q16(-250);
+		beta[1] = Q16(-250);
+		beta[2] = Q16(1000);
+		return;
+	}
+	// undo the scaling: each shift of a variable scales its coefficient the other way
+	int q = 16 + sideShift - matrixShift - scale[2];
+	beta[0] = div_q(ff * aw - af * fw, det, q + scale[0]);
+	beta[1] = div_q(aa * fw - af * aw, det, q + scale[1]);
+	int64_t w = (sumWeight - (((int64_t) beta[0] * sumAmp + (int64_t) beta[1] * sumFreq) >> 16)) / n;
+	beta[2] = w > INT32_MAX ? INT32_MAX : (w < -INT32_MAX ? -INT32_MAX : w);
 
-	//APP_LOG(APP_LOG_LEVEL_DEBUG, "w(0,0): %s, w(0,maxF): %s, w(maxA,0): %s, w(maxA,maxF): %s", floatStr(str1, beta[2], 2), floatStr(str2, beta[1]*maxFreq+beta[2], 2), floatStr(str3, beta[0]*maxAmp+beta[2], 2), floatStr(str4, beta[0]*maxAmp+beta[1]*maxFreq+beta[2], 2));
+	//char str1[8], str2[8], str3[8];
+	//APP_LOG(APP_LOG_LEVEL_DEBUG, "A: %s, F: %s, W: %s", fixedStr(str1, beta[0], 2), fixedStr(str2, beta[1], 2), fixedStr(str3, beta[2], 2));
 }
 
+// calibrations as stored before CALIBRATIONS_VERSION 1
+typedef struct {
+	float weight;
+	float freq;
+	float amp;
+	float confidence;
+} LegacyMeasurement;
+
 void calibrations_save() {
+	persist_write_int(storage_calibrations_version, CALIBRATIONS_VERSION);
 	persist_write_int(storage_calibrations_count, calibrations_count);
 	if (calibrations_count > 0) {
 		persist_write_data(storage_calibrations, calibrations, sizeof(Measurement) * calibrations_count);
@@ -404,6 +460,19 @@ void calibrations_load() {
 	if (!persist_exists(storage_calibrations_count))
 		return;
 	calibrations_count = persist_read_int(storage_calibrations_count);
-	persist_read_data(storage_calibrations, calibrations, sizeof(calibrations));
-	fit_data();
+	if (persist_exists(storage_calibrations_version)) {
+		persist_read_data(storage_calibrations, calibrations, sizeof(calibrations));
+		fit_data();
+		return;
+	}
+	// convert float calibrations once and store them again
+	LegacyMeasurement legacy[MAX_CALIBRATIONS];
+	persist_read_data(storage_calibrations, legacy, sizeof(legacy));
+	for (int i = 0; i < calibrations_count; i++) {
+		calibrations[i].weight = (int32_t) (legacy[i].weight + 0.5f);
+		calibrations[i].freq = (q16) (legacy[i].freq * 65536.0f);
+		calibrations[i].amp = (q16) (legacy[i].amp * 65536.0f);
+		calibrations[i].confidence = (q16) (legacy[i].confidence * 65536.0f);
+	}
+	calibrations_save();
 }
@@ -5,10 +5,12 @@
 #define MAX_CALIBRATIONS	8
 
 extern int16_t calibrations_count;
-extern float beta[3];
+// weight = beta[0] * amp + beta[1] * freq + beta[2], all Q16
+extern q16 beta[3];
 
 void calibrate_page_open();
 void calibrate_page_close();
 
 void calibrations_save();
 void calibrations_load();
+int32_t calibrated_weight(Measurement m);
@@ -0,0 +1,88 @@
+#include <pebble.h>
+#include "_kiss_fft_guts.h"
+#include "cic.h"
+
+#define CIC_MAX_GAIN (1 << 16)
+
+struct cic_state {
+	int factor;
+	int order;
+	int phase;					// input samples since the last output
+	int32_t gain;				// factor^order
+	uint32_t *integrator;
+	uint32_t *comb;			// previous input of each comb stage
+};
+
+cic_cfg cic_alloc(int factor, int order) {
+	if (factor < 1 || order < 1)
+		return NULL;
+	int32_t gain = 1;
+	for (int i = 0; i < order; i++) {
+		gain *= factor;
+		if (gain >= CIC_MAX_GAIN)
+			return NULL;
+	}
+	cic_cfg st = (cic_cfg) malloc(sizeof(struct cic_state) + sizeof(uint32_t) * 2 * order);
+	if (st == NULL)
+		return NULL;
+	st->factor = factor;
+	st->order = order;
+	st->gain = gain;
+	st->integrator = (uint32_t *) (st + 1);
+	st->comb = st->integrator + order;
+	cic_reset(st);
+	return st;
+}
+
+void cic_reset(cic_cfg st) {
+	st->phase = 0;
+	memset(st->integrator, 0, sizeof(uint32_t) * 2 * st->order);
+}
+
+bool cic_push(cic_cfg st, kiss_fft_scalar in, kiss_fft_scalar *out) {
+	uint32_t acc = (uint32_t) (int32_t) in;
+	for (int i = 0; i < st->order; i++) {
+		st->integrator[i] += acc;
+		acc = st->integrator[i];
+	}
+	if (++st->phase < st->factor)
+		return false;
+	st->phase = 0;
+	for (int i = 0; i < st->order; i++) {
+		uint32_t prev = st->comb[i];
+		st->comb[i] = acc;
+		acc -= prev;
+	}
+	// the wrapped differences are exact, at most gain * SAMP_MAX
+	int32_t val = (int32_t) acc;
+	val = (val + (val >= 0 ? st->gain / 2 : -st->gain / 2)) / st->gain;
+	*out = val;
+	return true;
+}
+
+// sin(x) for 0 <= x <= pi/2, both in Q30, Taylor series up to x^9 within 4e-6. sin_lookup only
+// has 16 bits of angle and ratio, too coarse for the small angles of the low bins, and aplite has no FPU
+static int32_t sin_q30(int32_t x) {
+	const int64_t one = 1 << 30;
+	int64_t x2 = ((int64_t) x * x) >> 30;
+	int64_t t = one - x2 / 72;
+	t = one - ((x2 * t) >> 30) / 42;
+	t = one - ((x2 * t) >> 30) / 20;
+	t = one - ((x2 * t) >> 30) / 6;
+	return (int32_t) ((x * t) >> 30);
+}
+
+int32_t cic_gain(cic_cfg st, int num, int den) {
+	// pi in Q30
+	const int64_t pi = 3373259426LL;
+	if (num == 0)
+		return 32768;
+	// only the pass band below half the output rate is of interest, where pi f factor <= pi/2
+	if (2 * num * st->factor > den)
+		return 0;
+	int64_t s = sin_q30(pi * num / den), sf = sin_q30(pi * num * st->factor / den);
+	int64_t g = (sf << 30) / (st->factor * s), p = 1 << 30;
+	for (int i = 0; i < st->order; i++)
+		p = (p * g) >> 30;
+	return (int32_t) ((p + (1 << 14)) >> 15);
+}
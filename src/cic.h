@@ -0,0 +1,28 @@
+#pragma once
+#include "kiss_fft.h"
+
+/*
+	Cascaded integrator comb decimator, low pass filters and keeps every factor-th sample.
+
+	order integrators run at the input rate and order combs at the output rate, all in
+	wrapping 32 bit arithmetic so the integrators may overflow without affecting the output.
+	The output is divided by the DC gain factor^order, so it stays in the input range.
+	The response is (sin(pi f factor) / (factor sin(pi f)))^order for f in cycles per input
+	sample, which has nulls on every multiple of the output rate where aliases would come from.
+*/
+
+typedef struct cic_state *cic_cfg;
+
+// factor^order must stay below 2^16 so the comb output fits int32, returns NULL otherwise
+cic_cfg cic_alloc(int factor, int order);
+
+// start over as if only zeros had been pushed
+void cic_reset(cic_cfg st);
+
+// add one input sample, returns true and writes *out every factor-th sample
+bool cic_push(cic_cfg st, kiss_fft_scalar in, kiss_fft_scalar *out);
+
+// gain at num / den cycles per input sample in Q15, 32768 at DC
+int32_t cic_gain(cic_cfg st, int num, int den);
+
+#define cic_free free
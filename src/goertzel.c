@@ -0,0 +1,77 @@
+#include <pebble.h>
+#include "_kiss_fft_guts.h"
+#include "goertzel.h"
+
+// the feedback coefficient is stored as 2 - 2cos(w) in Q28, a Q15 2cos(w) is too coarse for the low bins
+#define DELTA_BITS 28
+
+struct goertzel_state {
+	int nfft;
+	int min_bin;
+	int max_bin;
+	int32_t *delta_table;	// 2 - 2cos(2*pi*k/nfft) = 4sin(pi*k/nfft)^2 in Q28 per bin
+	int16_t *sin_table;		// sin(2*pi*k/nfft) in Q15 per bin
+};
+
+// sin(x) for 0 <= x <= pi/2, both in Q30, Taylor series up to x^9 as in cic.c. sin_lookup only
+// has 16 bits of angle and ratio, too coarse for the low bins, and aplite has no FPU
+static int32_t sin_q30(int32_t x) {
+	const int64_t one = 1 << 30;
+	int64_t x2 = ((int64_t) x * x) >> 30;
+	int64_t t = one - x2 / 72;
+	t = one - ((x2 * t) >> 30) / 42;
+	t = one - ((x2 * t) >> 30) / 20;
+	t = one - ((x2 * t) >> 30) / 6;
+	return (int32_t) ((x * t) >> 30);
+}
+
+goertzel_cfg goertzel_alloc(int nfft, int min_bin, int max_bin) {
+	// delta must stay below 8 in Q28
+	if (min_bin < 1 || max_bin < min_bin || max_bin >= nfft / 2)
+		return NULL;
+	int num_bins = max_bin - min_bin + 1;
+	goertzel_cfg st = (goertzel_cfg) malloc(sizeof(struct goertzel_state) + (sizeof(int32_t) + sizeof(int16_t)) * num_bins);
+	if (st == NULL)
+		return NULL;
+	st->nfft = nfft;
+	st->min_bin = min_bin;
+	st->max_bin = max_bin;
+	st->delta_table = (int32_t *) (st + 1);
+	st->sin_table = (int16_t *) (st->delta_table + num_bins);
+	// pi in Q30
+	const int64_t pi = 3373259426LL;
+	for (int k = min_bin; k <= max_bin; k++) {
+		// 4sin^2 in Q28 is sin^2 in Q30
+		int64_t s = sin_q30(pi * k / nfft);
+		st->delta_table[k - min_bin] = (int32_t) ((s * s + (1 << 29)) >> 30);
+		// sin(w) = sin(pi - w) above pi/2
+		int w = 4 * k <= nfft ? 2 * k : nfft - 2 * k;
+		st->sin_table[k - min_bin] = (int16_t) (((int64_t) sin_q30(pi * w / nfft) * SAMP_MAX + (1 << 29)) >> 30);
+	}
+	return st;
+}
+
+void goertzel_spectrum(goertzel_cfg st, const kiss_fft_scalar *buffer, uint32_t mask, uint32_t start, kiss_fft_cpx *freqdata) {
+	const int nfft = st->nfft;
+	int32_t sum = 0;
+	for (int n = 0; n < nfft; n++)
+		sum += buffer[(start + n) & mask];
+	freqdata[0].r = sum / nfft;
+	freqdata[0].i = 0;
+
+	// s[n] = x[n] + 2cos(w) * s[n-1] - s[n-2], stays below nfft * SAMP_MAX / sin(w) which fits for the low bins
+	for (int k = st->min_bin; k <= st->max_bin; k++) {
+		const int32_t delta = st->delta_table[k - st->min_bin], s = st->sin_table[k - st->min_bin];
+		int32_t s0, s1 = 0, s2 = 0;
+		for (int n = 0; n < nfft; n++) {
+			s0 = buffer[(start + n) & mask] + 2 * s1 - s2 - (int32_t) (((int64_t) delta * s1 + (1 << (DELTA_BITS - 1))) >> DELTA_BITS);
+			s2 = s1;
+			s1 = s0;
+		}
+		// X[k] = e^(jw) * s[N-1] - s[N-2] with cos(w) = 1 - delta / 2
+		int32_t re = s1 - s2 - (int32_t) (((int64_t) delta * s1) >> (DELTA_BITS + 1));
+		int32_t im = (int32_t) (((int64_t) s * s1) >> FRACBITS);
+		freqdata[k].r = re / nfft;
+		freqdata[k].i = im / nfft;
+	}
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include "kiss_fft.h"
+
+/*
+	Goertzel filter bank evaluating only bins min_bin..max_bin of an nfft point DFT.
+
+	Reads its input straight from a power of two ring buffer. Bin 0 is always filled
+	with the window mean so the caller still gets the DC offset.
+	Output uses the same 1/nfft scaling as kiss_fftr in fixed point.
+*/
+
+typedef struct goertzel_state *goertzel_cfg;
+
+goertzel_cfg goertzel_alloc(int nfft, int min_bin, int max_bin);
+
+// nfft samples starting at buffer[start & mask], writes freqdata[0] and freqdata[min_bin..max_bin]
+void goertzel_spectrum(goertzel_cfg st, const kiss_fft_scalar *buffer, uint32_t mask, uint32_t start, kiss_fft_cpx *freqdata);
+
+#define goertzel_free free
@@ -18,6 +18,15 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
  fixed or floating point complex numbers.  It also delares the kf_ internal functions.
  */
 
+#ifdef KISS_FFT_BFP
+#if !defined(FIXED_POINT) || !defined(KISS_FFT_ITERATIVE)
+#error "KISS_FFT_BFP needs FIXED_POINT and KISS_FFT_ITERATIVE"
+#endif
+/* stages are scaled as a block by kf_bfp_scale instead of dividing by the radix every time */
+#undef C_FIXDIV
+#define C_FIXDIV(c,div) /* NOOP */
+#endif
+
 static void kf_bfly2(
         kiss_fft_cpx * Fout,
         const size_t fstride,
@@ -26,7 +35,7 @@ static void kf_bfly2(
         )
 {
     kiss_fft_cpx * Fout2;
-    kiss_fft_cpx * tw1 = st->twiddles;
+    const kiss_fft_cpx * tw1 = st->twiddles;
     kiss_fft_cpx t;
     Fout2 = Fout + m;
     do{
@@ -48,7 +57,7 @@ static void kf_bfly4(
         const size_t m
         )
 {
-    kiss_fft_cpx *tw1,*tw2,*tw3;
+    const kiss_fft_cpx *tw1,*tw2,*tw3;
     kiss_fft_cpx scratch[6];
     size_t k=m;
     const size_t m2=2*m;
@@ -98,7 +107,7 @@ static void kf_bfly3(
 {
      size_t k=m;
      const size_t m2 = 2*m;
-     kiss_fft_cpx *tw1,*tw2;
+     const kiss_fft_cpx *tw1,*tw2;
      kiss_fft_cpx scratch[5];
      kiss_fft_cpx epi3;
      epi3 = st->twiddles[fstride*m];
@@ -143,8 +152,8 @@ static void kf_bfly5(
     kiss_fft_cpx *Fout0,*Fout1,*Fout2,*Fout3,*Fout4;
     int u;
     kiss_fft_cpx scratch[13];
-    kiss_fft_cpx * twiddles = st->twiddles;
-    kiss_fft_cpx *tw;
+    const kiss_fft_cpx * twiddles = st->twiddles;
+    const kiss_fft_cpx *tw;
     kiss_fft_cpx ya,yb;
     ya = twiddles[fstride*m];
     yb = twiddles[fstride*2*m];
@@ -204,7 +213,7 @@ static void kf_bfly_generic(
         )
 {
     int u,k,q1,q;
-    kiss_fft_cpx * twiddles = st->twiddles;
+    const kiss_fft_cpx * twiddles = st->twiddles;
     kiss_fft_cpx t;
     int Norig = st->nfft;
 
@@ -234,6 +243,7 @@ static void kf_bfly_generic(
     KISS_FFT_TMP_FREE(scratch);
 }
 
+#ifndef KISS_FFT_ITERATIVE
 static
 void kf_work(
         kiss_fft_cpx * Fout,
@@ -300,6 +310,163 @@ void kf_work(
         default: kf_bfly_generic(Fout,fstride,st,m,p); break;
     }
 }
+#endif
+
+#ifdef KISS_FFT_CODELETS
+#include "kiss_fft_codelets.h"
+#endif
+
+#ifdef KISS_FFT_ITERATIVE
+/* bring the input into the order the butterflies work on, in place when f == Fout */
+static
+void kf_permute(
+        kiss_fft_cpx * Fout,
+        const kiss_fft_cpx * f,
+        int in_stride,
+        const kiss_fft_cfg st
+        )
+{
+    const unsigned short * swaps = st->swaps;
+    kiss_fft_cpx t;
+    int i;
+
+    if (f != Fout)
+        for (i=0;i<st->nfft;++i)
+            Fout[i] = f[i * in_stride];
+    for (i=0;i<st->nfft;++i) {
+        if (swaps[i] != i) {
+            t = Fout[i];
+            Fout[i] = Fout[swaps[i]];
+            Fout[swaps[i]] = t;
+        }
+    }
+}
+
+#ifdef KISS_FFT_BFP
+/* shift the whole buffer down until a radix p stage cannot overflow, returns the shift.
+   an output component is at most p*sqrt(2) times the largest input component */
+static
+int kf_bfp_scale(kiss_fft_cpx * Fout, int n, int p)
+{
+    const int limit = SAMP_MAX * 2 / (3 * p);
+    int max = 0, shift = 0, i;
+    for (i=0;i<n;++i) {
+        int r = Fout[i].r < 0 ? -Fout[i].r : Fout[i].r;
+        int im = Fout[i].i < 0 ? -Fout[i].i : Fout[i].i;
+        if (r > max) max = r;
+        if (im > max) max = im;
+    }
+    while (((max + ((1 << shift) >> 1)) >> shift) > limit)
+        ++shift;
+    if (shift) {
+        const int round = 1 << (shift - 1);
+        for (i=0;i<n;++i) {
+            Fout[i].r = (Fout[i].r + round) >> shift;
+            Fout[i].i = (Fout[i].i + round) >> shift;
+        }
+    }
+    return shift;
+}
+#endif
+
+/* same butterflies in the same order per block as kf_work, so results are bit exact.
+   returns the block exponent, always 0 without KISS_FFT_BFP */
+static
+int kf_work_iterative(
+        kiss_fft_cpx * Fout,
+        const kiss_fft_cpx * f,
+        int in_stride,
+        const kiss_fft_cfg st
+        )
+{
+    kiss_fft_cpx * const Fout_end = Fout + st->nfft;
+    kiss_fft_cpx * block;
+    int s, exponent = 0;
+#ifdef KISS_FFT_CODELETS
+    const kf_codelet * codelets = kf_codelet_stages(st);
+#endif
+
+    kf_permute(Fout, f, in_stride, st);
+
+    for (s=0;s<st->nstages;++s) {
+        const int p = st->stages[s].p;
+        const int m = st->stages[s].m;
+        const size_t fstride = st->stages[s].fstride;
+#ifdef KISS_FFT_BFP
+        exponent += kf_bfp_scale(Fout, st->nfft, p);
+#endif
+#ifdef KISS_FFT_CODELETS
+        if (codelets) {
+            codelets[s](Fout);
+            continue;
+        }
+#endif
+        for (block=Fout;block!=Fout_end;block+=p*m) {
+            switch (p) {
+                case 2: kf_bfly2(block,fstride,st,m); break;
+                case 3: kf_bfly3(block,fstride,st,m); break;
+                case 4: kf_bfly4(block,fstride,st,m); break;
+                case 5: kf_bfly5(block,fstride,st,m); break;
+                default: kf_bfly_generic(block,fstride,st,m,p); break;
+            }
+        }
+    }
+    return exponent;
+}
+
+/* fill perm with the input index each leaf of kf_work copies to its output position */
+static
+void kf_perm(unsigned short * perm, int in, int fstride, const int * factors)
+{
+    const int p=*factors++;
+    const int m=*factors++;
+    int k;
+    for (k=0;k<p;++k) {
+        if (m==1)
+            perm[k] = in + k*fstride;
+        else
+            kf_perm(perm + k*m, in + k*fstride, fstride*p, factors);
+    }
+}
+
+/* turn perm into the swaps that apply it in place, scratch holds nfft shorts */
+static
+void kf_swaps(unsigned short * swaps, unsigned short * scratch, int nfft, const int * factors)
+{
+    unsigned short * perm = swaps;
+    unsigned short * pos = scratch;     /* current position of every input index */
+    int i;
+    kf_perm(perm, 0, 1, factors);
+    for (i=0;i<nfft;++i)
+        pos[i] = i;
+    for (i=0;i<nfft;++i) {
+        /* position i is final after this, so only later entries can still move */
+        int src = pos[perm[i]];
+        int j;
+        for (j=i+1;j<nfft;++j)
+            if (pos[perm[j]] == i)
+                pos[perm[j]] = src;
+        swaps[i] = src;
+    }
+}
+
+/* stages run from the innermost factor outwards */
+static
+void kf_schedule(kiss_fft_cfg st)
+{
+    kf_stage stages[MAXFACTORS];
+    int n=0, s, fstride=1;
+    do {
+        stages[n].p = st->factors[2*n];
+        stages[n].m = st->factors[2*n+1];
+        stages[n].fstride = fstride;
+        fstride *= stages[n].p;
+    } while (st->factors[2*n++ + 1] > 1);
+    st->nstages = n;
+    for (s=0;s<n;++s)
+        st->stages[s] = stages[n-1-s];
+}
+#endif
 
 static inline float mySqrt(const double x) {
 	const double xhalf = 0.5f*x;
@@ -347,8 +514,16 @@ void kf_factor(int n,int * facbuf)
 kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem )
 {
     kiss_fft_cfg st=NULL;
+#ifdef KISS_FFT_STATIC_PLAN
+    size_t memneeded = sizeof(struct kiss_fft_state)
+        + sizeof(kiss_fft_cpx)*nfft; /* twiddle factors follow the state */
+#else
     size_t memneeded = sizeof(struct kiss_fft_state)
         + sizeof(kiss_fft_cpx)*(nfft-1); /* twiddle factors*/
+#endif
+#ifdef KISS_FFT_ITERATIVE
+    memneeded += sizeof(unsigned short)*((nfft+1)&~1); /* swap table after the twiddles */
+#endif
 
     if ( lenmem==NULL ) {
         st = ( kiss_fft_cfg)KISS_FFT_MALLOC( memneeded );
@@ -359,6 +534,12 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
     }
     if (st) {
         int i;
+#ifdef KISS_FFT_STATIC_PLAN
+        kiss_fft_cpx * twiddles = (kiss_fft_cpx *) (st + 1);
+        st->twiddles = twiddles;
+#else
+        kiss_fft_cpx * twiddles = st->twiddles;
+#endif
         st->nfft=nfft;
         st->inverse = inverse_fft;
         for (i=0;i<nfft;++i) {
@@ -366,17 +547,41 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem
           double phase = -2*pi*i / nfft;
           if (st->inverse)
             phase *= -1;
-          kf_cexp(st->twiddles+i, phase );
+          kf_cexp(twiddles+i, phase );
         }
 
         kf_factor(nfft,st->factors);
+#ifdef KISS_FFT_ITERATIVE
+        {
+            unsigned short * swaps = (unsigned short *) (twiddles + nfft);
+            unsigned short * scratch = (unsigned short *) KISS_FFT_TMP_ALLOC(sizeof(unsigned short)*nfft);
+            kf_swaps(swaps, scratch, nfft, st->factors);
+            KISS_FFT_TMP_FREE(scratch);
+            st->swaps = swaps;
+            kf_schedule(st);
+        }
+#endif
     }
     return st;
 }
 
 
-void kiss_fft_stride(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int in_stride)
+int kiss_fft_stride(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int in_stride)
 {
+#ifdef KISS_FFT_ITERATIVE
+    int exponent;
+    /* the swaps permute in place and every butterfly works in place,
+       only a strided input that is also the output needs a temp buffer */
+    if (fin == fout && in_stride != 1) {
+        kiss_fft_cpx * tmpbuf = (kiss_fft_cpx*)KISS_FFT_TMP_ALLOC( sizeof(kiss_fft_cpx)*st->nfft);
+        exponent = kf_work_iterative(tmpbuf,fin,in_stride,st);
+        memcpy(fout,tmpbuf,sizeof(kiss_fft_cpx)*st->nfft);
+        KISS_FFT_TMP_FREE(tmpbuf);
+    }else{
+        exponent = kf_work_iterative( fout, fin, in_stride, st );
+    }
+    return exponent;
+#else
     if (fin == fout) {
         //NOTE: this is not really an in-place FFT algorithm.
         //It just performs an out-of-place FFT into a temp buffer
@@ -387,11 +592,13 @@ void kiss_fft_stride(kiss_fft_cfg st,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,
     }else{
         kf_work( fout, fin, 1,in_stride, st->factors,st );
     }
+    return 0;
+#endif
 }
 
-void kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout)
+int kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout)
 {
-    kiss_fft_stride(cfg,fin,fout,1);
+    return kiss_fft_stride(cfg,fin,fout,1);
 }
 
 
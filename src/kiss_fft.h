@@ -2,6 +2,16 @@
 #define KISS_FFT_H
 
 #define FIXED_POINT 16
+// use the plans generated by tools/gen_fft_plan.py instead of computing them at runtime
+#define KISS_FFT_STATIC_PLAN
+// run the butterflies from a precomputed stage schedule instead of recursing once per factor
+#define KISS_FFT_ITERATIVE
+// forward transforms of the generated sizes use the unrolled butterflies from tools/gen_fft_codelets.py
+// (needs KISS_FFT_ITERATIVE, the codelets only replace its stage loop)
+#define KISS_FFT_CODELETS
+// block floating point: stages only scale down when they could overflow and the transforms
+// return the shared exponent, output is X / 2^exponent instead of X / nfft (needs KISS_FFT_ITERATIVE)
+#define KISS_FFT_BFP
 
 #include "pebble.h"
 #include <stdlib.h>
@@ -92,13 +102,15 @@ kiss_fft_cfg kiss_fft_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem)
  * fout will be   F[0] , F[1] , ... ,F[nfft-1]
  * Note that each element is complex and can be accessed like
     f[k].r and f[k].i
+ * Returns the block exponent with KISS_FFT_BFP, fout is then X / 2^exponent.
+ * Otherwise fout is X / nfft in fixed point and 0 is returned.
  * */
-void kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout);
+int kiss_fft(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout);
 
 /*
  A more generic version of the above function. It reads its input from every Nth sample.
  * */
-void kiss_fft_stride(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int fin_stride);
+int kiss_fft_stride(kiss_fft_cfg cfg,const kiss_fft_cpx *fin,kiss_fft_cpx *fout,int fin_stride);
 
 /* If kiss_fft_alloc allocated a buffer, it is one contiguous 
    buffer and can be simply free()d when no longer needed*/
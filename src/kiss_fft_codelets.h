@@ -0,0 +1,333 @@
+// generated by tools/gen_fft_codelets.py --level 1 50 100 200, do not edit
+// forward butterfly codelets for kf_work_iterative, included by kiss_fft.c only
+
+/* the butterflies of one stage, in place on the permuted buffer */
+typedef void (*kf_codelet)(kiss_fft_cpx * Fout);
+
+/* radix 5, m = 1, 5 blocks */
+static void kf_codelet_25_s0(kiss_fft_cpx * Fout)
+{
+    kiss_fft_cpx scratch[13];
+    int b;
+
+    for (b=0; b<5; ++b, Fout+=5) {
+        C_FIXDIV(Fout[0],5); C_FIXDIV(Fout[1],5); C_FIXDIV(Fout[2],5); C_FIXDIV(Fout[3],5); C_FIXDIV(Fout[4],5);
+        scratch[0] = Fout[0];
+        C_MUL(scratch[1],Fout[1],((kiss_fft_cpx){ 32767, 0 }));
+        C_MUL(scratch[2],Fout[2],((kiss_fft_cpx){ 32767, 0 }));
+        C_MUL(scratch[3],Fout[3],((kiss_fft_cpx){ 32767, 0 }));
+        C_MUL(scratch[4],Fout[4],((kiss_fft_cpx){ 32767, 0 }));
+        C_ADD(scratch[7],scratch[1],scratch[4]);
+        C_SUB(scratch[10],scratch[1],scratch[4]);
+        C_ADD(scratch[8],scratch[2],scratch[3]);
+        C_SUB(scratch[9],scratch[2],scratch[3]);
+        Fout[0].r += scratch[7].r + scratch[8].r;
+        Fout[0].i += scratch[7].i + scratch[8].i;
+        scratch[5].r = scratch[0].r + S_MUL(scratch[7].r,10126) + S_MUL(scratch[8].r,-26509);
+        scratch[5].i = scratch[0].i + S_MUL(scratch[7].i,10126) + S_MUL(scratch[8].i,-26509);
+        scratch[6].r = S_MUL(scratch[10].i,-31163) + S_MUL(scratch[9].i,-19260);
+        scratch[6].i = -S_MUL(scratch[10].r,-31163) - S_MUL(scratch[9].r,-19260);
+        C_SUB(Fout[1],scratch[5],scratch[6]);
+        C_ADD(Fout[4],scratch[5],scratch[6]);
+        scratch[11].r = scratch[0].r + S_MUL(scratch[7].r,-26509) + S_MUL(scratch[8].r,10126);
+        scratch[11].i = scratch[0].i + S_MUL(scratch[7].i,-26509) + S_MUL(scratch[8].i,10126);
+        scratch[12].r = -S_MUL(scratch[10].i,-19260) + S_MUL(scratch[9].i,-31163);
+        scratch[12].i = S_MUL(scratch[10].r,-19260) - S_MUL(scratch[9].r,-31163);
+        C_ADD(Fout[2],scratch[11],scratch[12]);
+        C_SUB(Fout[3],scratch[11],scratch[12]);
+    }
+}
+
+static const kiss_fft_cpx kf_codelet_25_s1_tw[20] = {
+    { 32767, 0 }, { 32767, 0 }, { 32767, 0 }, { 32767, 0 },
+    { 31738, -8149 }, { 28714, -15786 }, { 23886, -22431 }, { 17557, -27666 },
+    { 28714, -15786 }, { 17557, -27666 }, { 2057, -32702 }, { -13952, -29648 },
+    { 23886, -22431 }, { 2057, -32702 }, { -20886, -25247 }, { -32509, -4107 },
+    { 17557, -27666 }, { -13952, -29648 }, { -32509, -4107 }, { -20886, 25247 },
+};
+/* radix 5, m = 5, 1 blocks */
+static void kf_codelet_25_s1(kiss_fft_cpx * Fout)
+{
+    kiss_fft_cpx scratch[13];
+    const kiss_fft_cpx * tw;
+    kiss_fft_cpx * F;
+    int u;
+
+    for (u=0, F=Fout, tw=kf_codelet_25_s1_tw; u<5; ++u, ++F, tw+=4) {
+        C_FIXDIV(F[0],5); C_FIXDIV(F[5],5); C_FIXDIV(F[10],5); C_FIXDIV(F[15],5); C_FIXDIV(F[20],5);
+        scratch[0] = F[0];
+        C_MUL(scratch[1],F[5],tw[0]);
+        C_MUL(scratch[2],F[10],tw[1]);
+        C_MUL(scratch[3],F[15],tw[2]);
+        C_MUL(scratch[4],F[20],tw[3]);
+        C_ADD(scratch[7],scratch[1],scratch[4]);
+        C_SUB(scratch[10],scratch[1],scratch[4]);
+        C_ADD(scratch[8],scratch[2],scratch[3]);
+        C_SUB(scratch[9],scratch[2],scratch[3]);
+        F[0].r += scratch[7].r + scratch[8].r;
+        F[0].i += scratch[7].i + scratch[8].i;
+        scratch[5].r = scratch[0].r + S_MUL(scratch[7].r,10126) + S_MUL(scratch[8].r,-26509);
+        scratch[5].i = scratch[0].i + S_MUL(scratch[7].i,10126) + S_MUL(scratch[8].i,-26509);
+        scratch[6].r = S_MUL(scratch[10].i,-31163) + S_MUL(scratch[9].i,-19260);
+        scratch[6].i = -S_MUL(scratch[10].r,-31163) - S_MUL(scratch[9].r,-19260);
+        C_SUB(F[5],scratch[5],scratch[6]);
+        C_ADD(F[20],scratch[5],scratch[6]);
+        scratch[11].r = scratch[0].r + S_MUL(scratch[7].r,-26509) + S_MUL(scratch[8].r,10126);
+        scratch[11].i = scratch[0].i + S_MUL(scratch[7].i,-26509) + S_MUL(scratch[8].i,10126);
+        scratch[12].r = -S_MUL(scratch[10].i,-19260) + S_MUL(scratch[9].i,-31163);
+        scratch[12].i = S_MUL(scratch[10].r,-19260) - S_MUL(scratch[9].r,-31163);
+        C_ADD(F[10],scratch[11],scratch[12]);
+        C_SUB(F[15],scratch[11],scratch[12]);
+    }
+}
+
+static const kf_codelet kf_codelets_25[2] = { kf_codelet_25_s0, kf_codelet_25_s1 };
+
+/* radix 5, m = 1, 10 blocks */
+static void kf_codelet_50_s0(kiss_fft_cpx * Fout)
+{
+    kiss_fft_cpx scratch[13];
+    int b;
+
+    for (b=0; b<10; ++b, Fout+=5) {
+        C_FIXDIV(Fout[0],5); C_FIXDIV(Fout[1],5); C_FIXDIV(Fout[2],5); C_FIXDIV(Fout[3],5); C_FIXDIV(Fout[4],5);
+        scratch[0] = Fout[0];
+        C_MUL(scratch[1],Fout[1],((kiss_fft_cpx){ 32767, 0 }));
+        C_MUL(scratch[2],Fout[2],((kiss_fft_cpx){ 32767, 0 }));
+        C_MUL(scratch[3],Fout[3],((kiss_fft_cpx){ 32767, 0 }));
+        C_MUL(scratch[4],Fout[4],((kiss_fft_cpx){ 32767, 0 }));
+        C_ADD(scratch[7],scratch[1],scratch[4]);
+        C_SUB(scratch[10],scratch[1],scratch[4]);
+        C_ADD(scratch[8],scratch[2],scratch[3]);
+        C_SUB(scratch[9],scratch[2],scratch[3]);
+        Fout[0].r += scratch[7].r + scratch[8].r;
+        Fout[0].i += scratch[7].i + scratch[8].i;
+        scratch[5].r = scratch[0].r + S_MUL(scratch[7].r,10126) + S_MUL(scratch[8].r,-26509);
+        scratch[5].i = scratch[0].i + S_MUL(scratch[7].i,10126) + S_MUL(scratch[8].i,-26509);
+        scratch[6].r = S_MUL(scratch[10].i,-31163) + S_MUL(scratch[9].i,-19260);
+        scratch[6].i = -S_MUL(scratch[10].r,-31163) - S_MUL(scratch[9].r,-19260);
+        C_SUB(Fout[1],scratch[5],scratch[6]);
+        C_ADD(Fout[4],scratch[5],scratch[6]);
+        scratch[11].r = scratch[0].r + S_MUL(scratch[7].r,-26509) + S_MUL(scratch[8].r,10126);
+        scratch[11].i = scratch[0].i + S_MUL(scratch[7].i,-26509) + S_MUL(scratch[8].i,10126);
+        scratch[12].r = -S_MUL(scratch[10].i,-19260) + S_MUL(scratch[9].i,-31163);
+        scratch[12].i = S_MUL(scratch[10].r,-19260) - S_MUL(scratch[9].r,-31163);
+        C_ADD(Fout[2],scratch[11],scratch[12]);
+        C_SUB(Fout[3],scratch[11],scratch[12]);
+    }
+}
+
+static const kiss_fft_cpx kf_codelet_50_s1_tw[20] = {
+    { 32767, 0 }, { 32767, 0 }, { 32767, 0 }, { 32767, 0 },
+    { 31738, -8149 }, { 28714, -15786 }, { 23886, -22431 }, { 17557, -27666 },
+    { 28714, -15786 }, { 17557, -27666 }, { 2057, -32702 }, { -13952, -29648 },
+    { 23886, -22431 }, { 2057, -32702 }, { -20886, -25247 }, { -32509, -4107 },
+    { 17557, -27666 }, { -13952, -29648 }, { -32509, -4107 }, { -20886, 25247 },
+};
+/* radix 5, m = 5, 2 blocks */
+static void kf_codelet_50_s1(kiss_fft_cpx * Fout)
+{
+    kiss_fft_cpx scratch[13];
+    const kiss_fft_cpx * tw;
+    kiss_fft_cpx * F;
+    int u;
+    int b;
+
+    for (b=0; b<2; ++b, Fout+=25) {
+        for (u=0, F=Fout, tw=kf_codelet_50_s1_tw; u<5; ++u, ++F, tw+=4) {
+            C_FIXDIV(F[0],5); C_FIXDIV(F[5],5); C_FIXDIV(F[10],5); C_FIXDIV(F[15],5); C_FIXDIV(F[20],5);
+            scratch[0] = F[0];
+            C_MUL(scratch[1],F[5],tw[0]);
+            C_MUL(scratch[2],F[10],tw[1]);
+            C_MUL(scratch[3],F[15],tw[2]);
+            C_MUL(scratch[4],F[20],tw[3]);
+            C_ADD(scratch[7],scratch[1],scratch[4]);
+            C_SUB(scratch[10],scratch[1],scratch[4]);
+            C_ADD(scratch[8],scratch[2],scratch[3]);
+            C_SUB(scratch[9],scratch[2],scratch[3]);
+            F[0].r += scratch[7].r + scratch[8].r;
+            F[0].i += scratch[7].i + scratch[8].i;
+            scratch[5].r = scratch[0].r + S_MUL(scratch[7].r,10126) + S_MUL(scratch[8].r,-26509);
+            scratch[5].i = scratch[0].i + S_MUL(scratch[7].i,10126) + S_MUL(scratch[8].i,-26509);
+            scratch[6].r = S_MUL(scratch[10].i,-31163) + S_MUL(scratch[9].i,-19260);
+            scratch[6].i = -S_MUL(scratch[10].r,-31163) - S_MUL(scratch[9].r,-19260);
+            C_SUB(F[5],scratch[5],scratch[6]);
+            C_ADD(F[20],scratch[5],scratch[6]);
+            scratch[11].r = scratch[0].r + S_MUL(scratch[7].r,-26509) + S_MUL(scratch[8].r,10126);
+            scratch[11].i = scratch[0].i + S_MUL(scratch[7].i,-26509) + S_MUL(scratch[8].i,10126);
+            scratch[12].r = -S_MUL(scratch[10].i,-19260) + S_MUL(scratch[9].i,-31163);
+            scratch[12].i = S_MUL(scratch[10].r,-19260) - S_MUL(scratch[9].r,-31163);
+            C_ADD(F[10],scratch[11],scratch[12]);
+            C_SUB(F[15],scratch[11],scratch[12]);
+        }
+    }
+}
+
+static const kiss_fft_cpx kf_codelet_50_s2_tw[25] = {
+    { 32767, 0 }, { 32509, -4107 }, { 31738, -8149 }, { 30466, -12062 },
+    { 28714, -15786 }, { 26509, -19260 }, { 23886, -22431 }, { 20886, -25247 },
+    { 17557, -27666 }, { 13952, -29648 }, { 10126, -31163 }, { 6140, -32187 },
+    { 2057, -32702 }, { -2057, -32702 }, { -6140, -32187 }, { -10126, -31163 },
+    { -13952, -29648 }, { -17557, -27666 }, { -20886, -25247 }, { -23886, -22431 },
+    { -26509, -19260 }, { -28714, -15786 }, { -30466, -12062 }, { -31738, -8149 },
+    { -32509, -4107 },
+};
+/* radix 2, m = 25, 1 blocks */
+static void kf_codelet_50_s2(kiss_fft_cpx * Fout)
+{
+    kiss_fft_cpx t;
+    const kiss_fft_cpx * tw;
+    kiss_fft_cpx * F;
+    int u;
+
+    for (u=0, F=Fout, tw=kf_codelet_50_s2_tw; u<25; ++u, ++F, tw+=1) {
+        C_FIXDIV(F[0],2); C_FIXDIV(F[25],2);
+        C_MUL(t,F[25],tw[0]);
+        C_SUB(F[25],F[0],t);
+        C_ADDTO(F[0],t);
+    }
+}
+
+static const kf_codelet kf_codelets_50[3] = { kf_codelet_50_s0, kf_codelet_50_s1, kf_codelet_50_s2 };
+
+/* radix 5, m = 1, 20 blocks */
+static void kf_codelet_100_s0(kiss_fft_cpx * Fout)
+{
+    kiss_fft_cpx scratch[13];
+    int b;
+
+    for (b=0; b<20; ++b, Fout+=5) {
+        C_FIXDIV(Fout[0],5); C_FIXDIV(Fout[1],5); C_FIXDIV(Fout[2],5); C_FIXDIV(Fout[3],5); C_FIXDIV(Fout[4],5);
+        scratch[0] = Fout[0];
+        C_MUL(scratch[1],Fout[1],((kiss_fft_cpx){ 32767, 0 }));
+        C_MUL(scratch[2],Fout[2],((kiss_fft_cpx){ 32767, 0 }));
+        C_MUL(scratch[3],Fout[3],((kiss_fft_cpx){ 32767, 0 }));
+        C_MUL(scratch[4],Fout[4],((kiss_fft_cpx){ 32767, 0 }));
+        C_ADD(scratch[7],scratch[1],scratch[4]);
+        C_SUB(scratch[10],scratch[1],scratch[4]);
+        C_ADD(scratch[8],scratch[2],scratch[3]);
+        C_SUB(scratch[9],scratch[2],scratch[3]);
+        Fout[0].r += scratch[7].r + scratch[8].r;
+        Fout[0].i += scratch[7].i + scratch[8].i;
+        scratch[5].r = scratch[0].r + S_MUL(scratch[7].r,10126) + S_MUL(scratch[8].r,-26509);
+        scratch[5].i = scratch[0].i + S_MUL(scratch[7].i,10126) + S_MUL(scratch[8].i,-26509);
+        scratch[6].r = S_MUL(scratch[10].i,-31163) + S_MUL(scratch[9].i,-19260);
+        scratch[6].i = -S_MUL(scratch[10].r,-31163) - S_MUL(scratch[9].r,-19260);
+        C_SUB(Fout[1],scratch[5],scratch[6]);
+        C_ADD(Fout[4],scratch[5],scratch[6]);
+        scratch[11].r = scratch[0].r + S_MUL(scratch[7].r,-26509) + S_MUL(scratch[8].r,10126);
+        scratch[11].i = scratch[0].i + S_MUL(scratch[7].i,-26509) + S_MUL(scratch[8].i,10126);
+        scratch[12].r = -S_MUL(scratch[10].i,-19260) + S_MUL(scratch[9].i,-31163);
+        scratch[12].i = S_MUL(scratch[10].r,-19260) - S_MUL(scratch[9].r,-31163);
+        C_ADD(Fout[2],scratch[11],scratch[12]);
+        C_SUB(Fout[3],scratch[11],scratch[12]);
+    }
+}
+
+static const kiss_fft_cpx kf_codelet_100_s1_tw[20] = {
+    { 32767, 0 }, { 32767, 0 }, { 32767, 0 }, { 32767, 0 },
+    { 31738, -8149 }, { 28714, -15786 }, { 23886, -22431 }, { 17557, -27666 },
+    { 28714, -15786 }, { 17557, -27666 }, { 2057, -32702 }, { -13952, -29648 },
+    { 23886, -22431 }, { 2057, -32702 }, { -20886, -25247 }, { -32509, -4107 },
+    { 17557, -27666 }, { -13952, -29648 }, { -32509, -4107 }, { -20886, 25247 },
+};
+/* radix 5, m = 5, 4 blocks */
+static void kf_codelet_100_s1(kiss_fft_cpx * Fout)
+{
+    kiss_fft_cpx scratch[13];
+    const kiss_fft_cpx * tw;
+    kiss_fft_cpx * F;
+    int u;
+    int b;
+
+    for (b=0; b<4; ++b, Fout+=25) {
+        for (u=0, F=Fout, tw=kf_codelet_100_s1_tw; u<5; ++u, ++F, tw+=4) {
+            C_FIXDIV(F[0],5); C_FIXDIV(F[5],5); C_FIXDIV(F[10],5); C_FIXDIV(F[15],5); C_FIXDIV(F[20],5);
+            scratch[0] = F[0];
+            C_MUL(scratch[1],F[5],tw[0]);
+            C_MUL(scratch[2],F[10],tw[1]);
+            C_MUL(scratch[3],F[15],tw[2]);
+            C_MUL(scratch[4],F[20],tw[3]);
+            C_ADD(scratch[7],scratch[1],scratch[4]);
+            C_SUB(scratch[10],scratch[1],scratch[4]);
+            C_ADD(scratch[8],scratch[2],scratch[3]);
+            C_SUB(scratch[9],scratch[2],scratch[3]);
+            F[0].r += scratch[7].r + scratch[8].r;
+            F[0].i += scratch[7].i + scratch[8].i;
+            scratch[5].r = scratch[0].r + S_MUL(scratch[7].r,10126) + S_MUL(scratch[8].r,-26509);
+            scratch[5].i = scratch[0].i + S_MUL(scratch[7].i,10126) + S_MUL(scratch[8].i,-26509);
+            scratch[6].r = S_MUL(scratch[10].i,-31163) + S_MUL(scratch[9].i,-19260);
+            scratch[6].i = -S_MUL(scratch[10].r,-31163) - S_MUL(scratch[9].r,-19260);
+            C_SUB(F[5],scratch[5],scratch[6]);
+            C_ADD(F[20],scratch[5],scratch[6]);
+            scratch[11].r = scratch[0].r + S_MUL(scratch[7].r,-26509) + S_MUL(scratch[8].r,10126);
+            scratch[11].i = scratch[0].i + S_MUL(scratch[7].i,-26509) + S_MUL(scratch[8].i,10126);
+            scratch[12].r = -S_MUL(scratch[10].i,-19260) + S_MUL(scratch[9].i,-31163);
+            scratch[12].i = S_MUL(scratch[10].r,-19260) - S_MUL(scratch[9].r,-31163);
+            C_ADD(F[10],scratch[11],scratch[12]);
+            C_SUB(F[15],scratch[11],scratch[12]);
+        }
+    }
+}
+
+static const kiss_fft_cpx kf_codelet_100_s2_tw[75] = {
+    { 32767, 0 }, { 32767, 0 }, { 32767, 0 }, { 32702, -2057 },
+    { 32509, -4107 }, { 32187, -6140 }, { 32509, -4107 }, { 31738, -8149 },
+    { 30466, -12062 }, { 32187, -6140 }, { 30466, -12062 }, { 27666, -17557 },
+    { 31738, -8149 }, { 28714, -15786 }, { 23886, -22431 }, { 31163, -10126 },
+    { 26509, -19260 }, { 19260, -26509 }, { 30466, -12062 }, { 23886, -22431 },
+    { 13952, -29648 }, { 29648, -13952 }, { 20886, -25247 }, { 8149, -31738 },
+    { 28714, -15786 }, { 17557, -27666 }, { 2057, -32702 }, { 27666, -17557 },
+    { 13952, -29648 }, { -4107, -32509 }, { 26509, -19260 }, { 10126, -31163 },
+    { -10126, -31163 }, { 25247, -20886 }, { 6140, -32187 }, { -15786, -28714 },
+    { 23886, -22431 }, { 2057, -32702 }, { -20886, -25247 }, { 22431, -23886 },
+    { -2057, -32702 }, { -25247, -20886 }, { 20886, -25247 }, { -6140, -32187 },
+    { -28714, -15786 }, { 19260, -26509 }, { -10126, -31163 }, { -31163, -10126 },
+    { 17557, -27666 }, { -13952, -29648 }, { -32509, -4107 }, { 15786, -28714 },
+    { -17557, -27666 }, { -32702, 2057 }, { 13952, -29648 }, { -20886, -25247 },
+    { -31738, 8149 }, { 12062, -30466 }, { -23886, -22431 }, { -29648, 13952 },
+    { 10126, -31163 }, { -26509, -19260 }, { -26509, 19260 }, { 8149, -31738 },
+    { -28714, -15786 }, { -22431, 23886 }, { 6140, -32187 }, { -30466, -12062 },
+    { -17557, 27666 }, { 4107, -32509 }, { -31738, -8149 }, { -12062, 30466 },
+    { 2057, -32702 }, { -32509, -4107 }, { -6140, 32187 },
+};
+/* radix 4, m = 25, 1 blocks */
+static void kf_codelet_100_s2(kiss_fft_cpx * Fout)
+{
+    kiss_fft_cpx scratch[13];
+    const kiss_fft_cpx * tw;
+    kiss_fft_cpx * F;
+    int u;
+
+    for (u=0, F=Fout, tw=kf_codelet_100_s2_tw; u<25; ++u, ++F, tw+=3) {
+        C_FIXDIV(F[0],4); C_FIXDIV(F[25],4); C_FIXDIV(F[50],4); C_FIXDIV(F[75],4);
+        C_MUL(scratch[0],F[25],tw[0]);
+        C_MUL(scratch[1],F[50],tw[1]);
+        C_MUL(scratch[2],F[75],tw[2]);
+        C_SUB(scratch[5],F[0],scratch[1]);
+        C_ADDTO(F[0],scratch[1]);
+        C_ADD(scratch[3],scratch[0],scratch[2]);
+        C_SUB(scratch[4],scratch[0],scratch[2]);
+        C_SUB(F[50],F[0],scratch[3]);
+        C_ADDTO(F[0],scratch[3]);
+        F[25].r = scratch[5].r + scratch[4].i;
+        F[25].i = scratch[5].i - scratch[4].r;
+        F[75].r = scratch[5].r - scratch[4].i;
+        F[75].i = scratch[5].i + scratch[4].r;
+    }
+}
+
+static const kf_codelet kf_codelets_100[3] = { kf_codelet_100_s0, kf_codelet_100_s1, kf_codelet_100_s2 };
+
+/* stage codelets for st in schedule order, NULL to use the generic butterflies */
+static const kf_codelet * kf_codelet_stages(const kiss_fft_cfg st)
+{
+    if (st->inverse)
+        return NULL;
+    switch (st->nfft) {
+        case 25: return kf_codelets_25;
+        case 50: return kf_codelets_50;
+        case 100: return kf_codelets_100;
+    }
+    return NULL;
+}
@@ -0,0 +1,161 @@
+// generated by tools/gen_fft_plan.py 50 100 200, do not edit
+// static forward plans for kiss_fftr_alloc, included by kiss_fftr.c only
+
+static const kiss_fft_cpx kiss_fft_plan_twiddles_50[25] = {
+	{ 32767, 0 }, { 31738, -8149 }, { 28714, -15786 }, { 23886, -22431 },
+	{ 17557, -27666 }, { 10126, -31163 }, { 2057, -32702 }, { -6140, -32187 },
+	{ -13952, -29648 }, { -20886, -25247 }, { -26509, -19260 }, { -30466, -12062 },
+	{ -32509, -4107 }, { -32509, 4107 }, { -30466, 12062 }, { -26509, 19260 },
+	{ -20886, 25247 }, { -13952, 29648 }, { -6140, 32187 }, { 2057, 32702 },
+	{ 10126, 31163 }, { 17557, 27666 }, { 23886, 22431 }, { 28714, 15786 },
+	{ 31738, 8149 },
+};
+static const kiss_fft_cpx kiss_fft_plan_super_twiddles_50[12] = {
+	{ -4107, -32509 }, { -8149, -31738 }, { -12062, -30466 }, { -15786, -28714 },
+	{ -19260, -26509 }, { -22431, -23886 }, { -25247, -20886 }, { -27666, -17557 },
+	{ -29648, -13952 }, { -31163, -10126 }, { -32187, -6140 }, { -32702, -2057 },
+};
+#ifdef KISS_FFT_ITERATIVE
+static const unsigned short kiss_fft_plan_swaps_50[25] = {
+	0, 5, 10, 15, 20, 5, 6, 11, 16, 21, 10, 11, 12, 17, 22, 15,
+	16, 17, 18, 23, 20, 21, 22, 23, 24,
+};
+#endif
+static struct kiss_fft_state kiss_fft_plan_substate_50 = {
+	.nfft = 25,
+	.inverse = 0,
+	.factors = { 5, 5, 5, 1 },
+#ifdef KISS_FFT_ITERATIVE
+	.nstages = 2,
+	.stages = { { 5, 1, 5 }, { 5, 5, 1 } },
+	.swaps = kiss_fft_plan_swaps_50,
+#endif
+	.twiddles = kiss_fft_plan_twiddles_50,
+};
+// forward transforms need no tmpbuf
+static struct kiss_fftr_state kiss_fft_plan_50 = {
+	.substate = &kiss_fft_plan_substate_50,
+	.super_twiddles = kiss_fft_plan_super_twiddles_50,
+};
+
+static const kiss_fft_cpx kiss_fft_plan_twiddles_100[50] = {
+	{ 32767, 0 }, { 32509, -4107 }, { 31738, -8149 }, { 30466, -12062 },
+	{ 28714, -15786 }, { 26509, -19260 }, { 23886, -22431 }, { 20886, -25247 },
+	{ 17557, -27666 }, { 13952, -29648 }, { 10126, -31163 }, { 6140, -32187 },
+	{ 2057, -32702 }, { -2057, -32702 }, { -6140, -32187 }, { -10126, -31163 },
+	{ -13952, -29648 }, { -17557, -27666 }, { -20886, -25247 }, { -23886, -22431 },
+	{ -26509, -19260 }, { -28714, -15786 }, { -30466, -12062 }, { -31738, -8149 },
+	{ -32509, -4107 }, { -32767, 0 }, { -32509, 4107 }, { -31738, 8149 },
+	{ -30466, 12062 }, { -28714, 15786 }, { -26509, 19260 }, { -23886, 22431 },
+	{ -20886, 25247 }, { -17557, 27666 }, { -13952, 29648 }, { -10126, 31163 },
+	{ -6140, 32187 }, { -2057, 32702 }, { 2057, 32702 }, { 6140, 32187 },
+	{ 10126, 31163 }, { 13952, 29648 }, { 17557, 27666 }, { 20886, 25247 },
+	{ 23886, 22431 }, { 26509, 19260 }, { 28714, 15786 }, { 30466, 12062 },
+	{ 31738, 8149 }, { 32509, 4107 },
+};
+static const kiss_fft_cpx kiss_fft_plan_super_twiddles_100[25] = {
+	{ -2057, -32702 }, { -4107, -32509 }, { -6140, -32187 }, { -8149, -31738 },
+	{ -10126, -31163 }, { -12062, -30466 }, { -13952, -29648 }, { -15786, -28714 },
+	{ -17557, -27666 }, { -19260, -26509 }, { -20886, -25247 }, { -22431, -23886 },
+	{ -23886, -22431 }, { -25247, -20886 }, { -26509, -19260 }, { -27666, -17557 },
+	{ -28714, -15786 }, { -29648, -13952 }, { -30466, -12062 }, { -31163, -10126 },
+	{ -31738, -8149 }, { -32187, -6140 }, { -32509, -4107 }, { -32702, -2057 },
+	{ -32767, 0 },
+};
+#ifdef KISS_FFT_ITERATIVE
+static const unsigned short kiss_fft_plan_swaps_100[50] = {
+	0, 10, 20, 30, 40, 20, 12, 22, 32, 42, 40, 14, 24, 34, 44, 24,
+	16, 26, 36, 46, 32, 36, 28, 38, 48, 40, 44, 36, 31, 41, 30, 34,
+	38, 33, 43, 38, 48, 40, 38, 45, 43, 44, 48, 43, 47, 48, 46, 47,
+	48, 49,
+};
+#endif
+static struct kiss_fft_state kiss_fft_plan_substate_100 = {
+	.nfft = 50,
+	.inverse = 0,
+	.factors = { 2, 25, 5, 5, 5, 1 },
+#ifdef KISS_FFT_ITERATIVE
+	.nstages = 3,
+	.stages = { { 5, 1, 10 }, { 5, 5, 2 }, { 2, 25, 1 } },
+	.swaps = kiss_fft_plan_swaps_100,
+#endif
+	.twiddles = kiss_fft_plan_twiddles_100,
+};
+// forward transforms need no tmpbuf
+static struct kiss_fftr_state kiss_fft_plan_100 = {
+	.substate = &kiss_fft_plan_substate_100,
+	.super_twiddles = kiss_fft_plan_super_twiddles_100,
+};
+
+static const kiss_fft_cpx kiss_fft_plan_twiddles_200[100] = {
+	{ 32767, 0 }, { 32702, -2057 }, { 32509, -4107 }, { 32187, -6140 },
+	{ 31738, -8149 }, { 31163, -10126 }, { 30466, -12062 }, { 29648, -13952 },
+	{ 28714, -15786 }, { 27666, -17557 }, { 26509, -19260 }, { 25247, -20886 },
+	{ 23886, -22431 }, { 22431, -23886 }, { 20886, -25247 }, { 19260, -26509 },
+	{ 17557, -27666 }, { 15786, -28714 }, { 13952, -29648 }, { 12062, -30466 },
+	{ 10126, -31163 }, { 8149, -31738 }, { 6140, -32187 }, { 4107, -32509 },
+	{ 2057, -32702 }, { 0, -32767 }, { -2057, -32702 }, { -4107, -32509 },
+	{ -6140, -32187 }, { -8149, -31738 }, { -10126, -31163 }, { -12062, -30466 },
+	{ -13952, -29648 }, { -15786, -28714 }, { -17557, -27666 }, { -19260, -26509 },
+	{ -20886, -25247 }, { -22431, -23886 }, { -23886, -22431 }, { -25247, -20886 },
+	{ -26509, -19260 }, { -27666, -17557 }, { -28714, -15786 }, { -29648, -13952 },
+	{ -30466, -12062 }, { -31163, -10126 }, { -31738, -8149 }, { -32187, -6140 },
+	{ -32509, -4107 }, { -32702, -2057 }, { -32767, 0 }, { -32702, 2057 },
+	{ -32509, 4107 }, { -32187, 6140 }, { -31738, 8149 }, { -31163, 10126 },
+	{ -30466, 12062 }, { -29648, 13952 }, { -28714, 15786 }, { -27666, 17557 },
+	{ -26509, 19260 }, { -25247, 20886 }, { -23886, 22431 }, { -22431, 23886 },
+	{ -20886, 25247 }, { -19260, 26509 }, { -17557, 27666 }, { -15786, 28714 },
+	{ -13952, 29648 }, { -12062, 30466 }, { -10126, 31163 }, { -8149, 31738 },
+	{ -6140, 32187 }, { -4107, 32509 }, { -2057, 32702 }, { 0, 32767 },
+	{ 2057, 32702 }, { 4107, 32509 }, { 6140, 32187 }, { 8149, 31738 },
+	{ 10126, 31163 }, { 12062, 30466 }, { 13952, 29648 }, { 15786, 28714 },
+	{ 17557, 27666 }, { 19260, 26509 }, { 20886, 25247 }, { 22431, 23886 },
+	{ 23886, 22431 }, { 25247, 20886 }, { 26509, 19260 }, { 27666, 17557 },
+	{ 28714, 15786 }, { 29648, 13952 }, { 30466, 12062 }, { 31163, 10126 },
+	{ 31738, 8149 }, { 32187, 6140 }, { 32509, 4107 }, { 32702, 2057 },
+};
+static const kiss_fft_cpx kiss_fft_plan_super_twiddles_200[50] = {
+	{ -1029, -32751 }, { -2057, -32702 }, { -3084, -32622 }, { -4107, -32509 },
+	{ -5126, -32364 }, { -6140, -32187 }, { -7148, -31978 }, { -8149, -31738 },
+	{ -9142, -31466 }, { -10126, -31163 }, { -11099, -30830 }, { -12062, -30466 },
+	{ -13013, -30072 }, { -13952, -29648 }, { -14876, -29196 }, { -15786, -28714 },
+	{ -16680, -28204 }, { -17557, -27666 }, { -18418, -27101 }, { -19260, -26509 },
+	{ -20083, -25891 }, { -20886, -25247 }, { -21669, -24579 }, { -22431, -23886 },
+	{ -23170, -23170 }, { -23886, -22431 }, { -24579, -21669 }, { -25247, -20886 },
+	{ -25891, -20083 }, { -26509, -19260 }, { -27101, -18418 }, { -27666, -17557 },
+	{ -28204, -16680 }, { -28714, -15786 }, { -29196, -14876 }, { -29648, -13952 },
+	{ -30072, -13013 }, { -30466, -12062 }, { -30830, -11099 }, { -31163, -10126 },
+	{ -31466, -9142 }, { -31738, -8149 }, { -31978, -7148 }, { -32187, -6140 },
+	{ -32364, -5126 }, { -32509, -4107 }, { -32622, -3084 }, { -32702, -2057 },
+	{ -32751, -1029 }, { -32767, 0 },
+};
+#ifdef KISS_FFT_ITERATIVE
+static const unsigned short kiss_fft_plan_swaps_200[100] = {
+	0, 20, 40, 60, 80, 80, 24, 44, 64, 84, 64, 28, 48, 68, 88, 48,
+	32, 52, 72, 92, 32, 36, 56, 76, 96, 32, 36, 41, 61, 81, 80, 32,
+	45, 65, 85, 84, 81, 49, 69, 89, 68, 65, 53, 73, 93, 52, 49, 57,
+	77, 97, 68, 56, 53, 62, 82, 96, 81, 97, 66, 86, 64, 80, 68, 70,
+	90, 88, 85, 82, 74, 94, 72, 94, 85, 78, 98, 90, 76, 78, 85, 83,
+	93, 88, 97, 97, 87, 93, 98, 88, 94, 91, 93, 94, 96, 93, 95, 96,
+	96, 98, 98, 99,
+};
+#endif
+static struct kiss_fft_state kiss_fft_plan_substate_200 = {
+	.nfft = 100,
+	.inverse = 0,
+	.factors = { 4, 25, 5, 5, 5, 1 },
+#ifdef KISS_FFT_ITERATIVE
+	.nstages = 3,
+	.stages = { { 5, 1, 20 }, { 5, 5, 4 }, { 4, 25, 1 } },
+	.swaps = kiss_fft_plan_swaps_200,
+#endif
+	.twiddles = kiss_fft_plan_twiddles_200,
+};
+// forward transforms need no tmpbuf
+static struct kiss_fftr_state kiss_fft_plan_200 = {
+	.substate = &kiss_fft_plan_substate_200,
+	.super_twiddles = kiss_fft_plan_super_twiddles_200,
+};
+
+static const kiss_fftr_cfg kiss_fft_plans[] = { &kiss_fft_plan_50, &kiss_fft_plan_100, &kiss_fft_plan_200 };
+#define KISS_FFT_NUM_PLANS 3
@@ -0,0 +1,4 @@
+// generated by tools/gen_fft_plan.py 50 100 200, do not edit
+// sizes of the static plans in kiss_fft_plan.h, kiss_fftr_alloc returns NULL for any other
+#pragma once
+#define KISS_FFT_HAS_PLAN(nfft) ((nfft) == 50 || (nfft) == 100 || (nfft) == 200)
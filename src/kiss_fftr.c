@@ -18,12 +18,32 @@ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
 struct kiss_fftr_state{
     kiss_fft_cfg substate;
     kiss_fft_cpx * tmpbuf;
+#ifdef KISS_FFT_STATIC_PLAN
+    const kiss_fft_cpx * super_twiddles;
+#else
     kiss_fft_cpx * super_twiddles;
+#endif
 #ifdef USE_SIMD
     void * pad;
 #endif
 };
 
+#ifdef KISS_FFT_STATIC_PLAN
+#include "kiss_fft_plan.h"
+
+/* only the generated forward plans are available, mem and lenmem are ignored */
+kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem)
+{
+    int i;
+    if (inverse_fft)
+        return NULL;
+    for (i = 0; i < KISS_FFT_NUM_PLANS; ++i) {
+        if (kiss_fft_plans[i]->substate->nfft * 2 == nfft)
+            return kiss_fft_plans[i];
+    }
+    return NULL;
+}
+#else
 kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenmem)
 {
     int i;
@@ -63,22 +83,18 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem,size_t * lenme
     }
     return st;
 }
+#endif
 
-void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata)
+/* turn the complex fft of the even/odd packed input into the real spectrum, in place.
+   bins 0..ncfft-1 stay in freqdata, the real nyquist bin is returned */
+static kiss_fft_scalar kf_fftr_split(kiss_fftr_cfg st,kiss_fft_cpx *freqdata)
 {
-    /* input buffer timedata is stored row-wise */
     int k,ncfft;
     kiss_fft_cpx fpnk,fpk,f1k,f2k,tw,tdc;
-    if ( st->substate->inverse) {
-        //fprintf(stderr,"kiss fft usage error: improper alloc\n");
-        return; //exit(1);
-    }
 
     ncfft = st->substate->nfft;
 
-    /*perform the parallel fft of two real signals packed in real,imag*/
-    kiss_fft( st->substate , (const kiss_fft_cpx*)timedata, st->tmpbuf );
-    /* The real part of the DC element of the frequency spectrum in st->tmpbuf
+    /* The real part of the DC element of the frequency spectrum in freqdata
      * contains the sum of the even-numbered elements of the input time sequence
      * The imag part is the sum of the odd-numbered elements
      *
@@ -88,23 +104,23 @@ void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *fr
      *      yielding Nyquist bin of input time sequence
      */
  
-    tdc.r = st->tmpbuf[0].r;
-    tdc.i = st->tmpbuf[0].i;
+    tdc.r = freqdata[0].r;
+    tdc.i = freqdata[0].i;
     C_FIXDIV(tdc,2);
     CHECK_OVERFLOW_OP(tdc.r ,+, tdc.i);
     CHECK_OVERFLOW_OP(tdc.r ,-, tdc.i);
     freqdata[0].r = tdc.r + tdc.i;
-    freqdata[ncfft].r = tdc.r - tdc.i;
 #ifdef USE_SIMD    
-    freqdata[ncfft].i = freqdata[0].i = _mm_set1_ps(0);
+    freqdata[0].i = _mm_set1_ps(0);
 #else
-    freqdata[ncfft].i = freqdata[0].i = 0;
+    freqdata[0].i = 0;
 #endif
 
+    /* bins k and ncfft-k are both read before either is written */
     for ( k=1;k <= ncfft/2 ; ++k ) {
-        fpk    = st->tmpbuf[k]; 
-        fpnk.r =   st->tmpbuf[ncfft-k].r;
-        fpnk.i = - st->tmpbuf[ncfft-k].i;
+        fpk    = freqdata[k]; 
+        fpnk.r =   freqdata[ncfft-k].r;
+        fpnk.i = - freqdata[ncfft-k].i;
         C_FIXDIV(fpk,2);
         C_FIXDIV(fpnk,2);
 
@@ -117,16 +133,61 @@ void kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *fr
         freqdata[ncfft-k].r = HALF_OF(f1k.r - tw.r);
         freqdata[ncfft-k].i = HALF_OF(tw.i - f1k.i);
     }
+    return tdc.r - tdc.i;
+}
+
+/* the split halves once more, so a block exponent grows by one */
+#ifdef KISS_FFT_BFP
+#define KF_SPLIT_EXPONENT 1
+#else
+#define KF_SPLIT_EXPONENT 0
+#endif
+
+int kiss_fftr(kiss_fftr_cfg st,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata)
+{
+    /* input buffer timedata is stored row-wise */
+    int ncfft, exponent;
+    if ( st->substate->inverse) {
+        //fprintf(stderr,"kiss fft usage error: improper alloc\n");
+        return 0; //exit(1);
+    }
+
+    ncfft = st->substate->nfft;
+
+    /*perform the parallel fft of two real signals packed in real,imag*/
+    /* freqdata holds ncfft+1 points so the split needs no tmpbuf */
+    exponent = kiss_fft( st->substate , (const kiss_fft_cpx*)timedata, freqdata );
+    freqdata[ncfft].r = kf_fftr_split(st, freqdata);
+#ifdef USE_SIMD    
+    freqdata[ncfft].i = _mm_set1_ps(0);
+#else
+    freqdata[ncfft].i = 0;
+#endif
+    return exponent + KF_SPLIT_EXPONENT;
+}
+
+int kiss_fftr_inplace(kiss_fftr_cfg st,kiss_fft_scalar *data)
+{
+    kiss_fft_cpx * freqdata = (kiss_fft_cpx*)data;
+    int exponent;
+    if ( st->substate->inverse) {
+        return 0;
+    }
+
+    exponent = kiss_fft( st->substate , freqdata, freqdata );
+    /* the nyquist bin is real, it takes the place of the always zero imaginary part of DC */
+    freqdata[0].i = kf_fftr_split(st, freqdata);
+    return exponent + KF_SPLIT_EXPONENT;
 }
 
-void kiss_fftri(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata)
+int kiss_fftri(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata)
 {
     /* input buffer timedata is stored row-wise */
     int k, ncfft;
 
     if (st->substate->inverse == 0) {
         //fprintf (stderr, "kiss fft usage error: improper alloc\n");
-        return; //exit (1);
+        return 0; //exit (1);
     }
 
     ncfft = st->substate->nfft;
@@ -154,5 +215,5 @@ void kiss_fftri(kiss_fftr_cfg st,const kiss_fft_cpx *freqdata,kiss_fft_scalar *t
         st->tmpbuf[ncfft - k].i *= -1;
 #endif
     }
-    kiss_fft (st->substate, st->tmpbuf, (kiss_fft_cpx *) timedata);
+    return kiss_fft (st->substate, st->tmpbuf, (kiss_fft_cpx *) timedata) + KF_SPLIT_EXPONENT;
 }
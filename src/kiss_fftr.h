@@ -26,19 +26,33 @@ kiss_fftr_cfg kiss_fftr_alloc(int nfft,int inverse_fft,void * mem, size_t * lenm
 */
 
 
-void kiss_fftr(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata);
+int kiss_fftr(kiss_fftr_cfg cfg,const kiss_fft_scalar *timedata,kiss_fft_cpx *freqdata);
 /*
  input timedata has nfft scalar points
  output freqdata has nfft/2+1 complex points
+ returns the block exponent like kiss_fft, with KISS_FFT_BFP freqdata is X / 2^exponent
 */
 
-void kiss_fftri(kiss_fftr_cfg cfg,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata);
+int kiss_fftr_inplace(kiss_fftr_cfg cfg,kiss_fft_scalar *data);
+/*
+ data has nfft scalar points in and is read as nfft/2 kiss_fft_cpx points out, packed:
+ data[0].r is DC, data[0].i the real Nyquist bin, data[k] bin k for 0 < k < nfft/2
+ With KISS_FFT_ITERATIVE this needs no memory beyond data.
+*/
+
+int kiss_fftri(kiss_fftr_cfg cfg,const kiss_fft_cpx *freqdata,kiss_fft_scalar *timedata);
 /*
  input freqdata has  nfft/2+1 complex points
  output timedata has nfft scalar points
+ returns the block exponent like kiss_fftr
 */
 
+#ifdef KISS_FFT_STATIC_PLAN
+/* static plans are never freed */
+#define kiss_fftr_free(cfg)
+#else
 #define kiss_fftr_free free
+#endif
 
 #ifdef __cplusplus
 }
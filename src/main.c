@@ -14,11 +14,13 @@ static Layer *icon_layer;
 
 GFont font_huge, font_large, font_medium, font_tiny, font_symbols, font_symbols_small;
 
-static kiss_fft_scalar *cur_data;
-static uint32_t cur_num_samples;
+static SampleView cur_samples;
 static kiss_fft_scalar cur_offset;
 static Measurement measurement;
-static float final_weight = -1;
+// grams, -1 before the first measurement and -2 when it failed
+static int32_t final_weight = -1;
+// keep weighing after a final value and show the live weight
+static bool continuous;
 
 const char *icon_plus = "5";
 const char *icon_minus = "7";
@@ -44,7 +46,8 @@ Weighing\n\n\
 1. Hold the object in the hand where you are wearing Pebble.\n\
 2. Press the middle button to start.\n\
 3. Move your hand up and down, making sure that it takes the same effort like during calibration. The better you can keep the same effort, the more accurate your measurement will be.\n\
-4. Pebble will buzz shortly to let you know when a value was measured and show the weight on the screen.";
+4. Pebble will buzz shortly to let you know when a value was measured and show the weight on the screen.\n\n\
+Hold the middle button instead to keep weighing: the weight updates while you move and Pebble buzzes when it settles on a new one.";
 static const char *text_main_need_calibration = "\
 Not enough calibration values.\n\n\
 Proceed to calibration --->";
@@ -54,25 +57,36 @@ static const char *text_main_measurement_failed = "Measurement failed. You might
 static const char *text_main_measure_hint = "Move hand up and down in a steady motion";
 static const char *text_main_frequency = "Freq";
 static const char *text_main_amplitude = "\nAmp";
+static const char *text_main_weight = "Weight";
+static const char *text_main_stable = "\nStable";
+static const char *text_main_spread = "\n+-%dg";
 
 
 /**
 	Measure handlers
 **/
 
-void handle_measure(kiss_fft_scalar *data, uint32_t num_samples, kiss_fft_scalar offset, Measurement m) {
-	cur_data = data;
-	cur_num_samples = num_samples;
+void handle_measure(SampleView samples, kiss_fft_scalar offset, Measurement m) {
+	cur_samples = samples;
 	cur_offset = offset;
 	measurement = m;
 	layer_mark_dirty(graph_layer);
 }
 void handle_final(Measurement m) {
 	// calculate weight using coefficients
-	final_weight = beta[0] * m.amp + beta[1] * m.freq + beta[2];
+	int32_t last_weight = final_weight;
+	final_weight = calibrated_weight(m);
 	if (final_weight < 0)
 		final_weight = -2;
 
+	if (continuous) {
+		// keep measuring, only buzz when the load changed
+		if (final_weight >= 0 && (last_weight < 0 || abs(final_weight - last_weight) > MEASURE_TOLERANCE_DEFAULT))
+			vibes_short_pulse();
+		layer_mark_dirty(graph_layer);
+		return;
+	}
+
 	// stop measuring and update layers
 	stop_measure();
 	layer_mark_dirty(graph_layer);
@@ -102,14 +116,13 @@ static void graph_layer_update_callback(Layer *me, GContext *ctx) {
 		}
 		return;
 	}
-	if (cur_data == NULL)
+	if (cur_samples.buffer == NULL)
 		return;
 
 	// display graph
 	const int16_t mid = frame.size.h - GRAPH_HEIGHT;
-	const float step = (float) cur_num_samples / (float) frame.size.w;
 	for (int i = 0; i < frame.size.w; i++) {
-		int16_t h = (int32_t) (cur_data[(int)(i * step)] - cur_offset) * GRAPH_HEIGHT / SAMP_MAX;
+		int16_t h = (int32_t) (sample_view_get(cur_samples, i * cur_samples.count / frame.size.w) - cur_offset) * GRAPH_HEIGHT / SAMP_MAX;
 		int16_t y;
 		if (h >= 0)
 			y = mid - h;
@@ -120,22 +133,37 @@ static void graph_layer_update_callback(Layer *me, GContext *ctx) {
 		graphics_fill_rect(ctx, GRect(i, y, 1, h), 0, GCornerNone);
 	}
 	graphics_fill_rect(ctx, GRect(0, frame.size.h - 2 * GRAPH_HEIGHT, frame.size.w, 1), 0, GCornerNone);
-	dashed_line_h(ctx, GPoint(0, frame.size.h - 1.75 * GRAPH_HEIGHT), frame.size.w, 1, 1);
+	dashed_line_h(ctx, GPoint(0, frame.size.h - 7 * GRAPH_HEIGHT / 4), frame.size.w, 1, 1);
 	dashed_line_h(ctx, GPoint(0, frame.size.h - GRAPH_HEIGHT), frame.size.w, 2, 2);
-	dashed_line_h(ctx, GPoint(0, frame.size.h - 0.25 * GRAPH_HEIGHT), frame.size.w, 1, 1);
+	dashed_line_h(ctx, GPoint(0, frame.size.h - GRAPH_HEIGHT / 4), frame.size.w, 1, 1);
 	
 	// display text
-	if (measurement.confidence <= 0.2) {
+	if (measurement.confidence < MEASURE_SNR_VISIBLE) {
 		graphics_draw_text(ctx, text_main_measure_hint, font_medium, text_frame, GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+	} else if (continuous) {
+		int h = frame.size.h - 2 * GRAPH_HEIGHT;
+		// line 1: live weight
+		GRect info_frame = GRect(0, 0, frame.size.w, h / 2);
+		snprintf(str, sizeof(str), text_main_weight_result, (int) measurement.weight);
+		graphics_draw_text(ctx, text_main_weight, font_medium, info_frame, GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+		graphics_draw_text(ctx, str, font_medium, info_frame, GTextOverflowModeWordWrap, GTextAlignmentRight, NULL);
+		// line 2: stable within the tolerance or how far off it may be
+		int32_t spread = measure_weight_spread();
+		if (spread >= 0 && spread <= MEASURE_TOLERANCE_DEFAULT) {
+			graphics_draw_text(ctx, text_main_stable, font_medium, info_frame, GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
+		} else if (spread >= 0) {
+			snprintf(str, sizeof(str), text_main_spread, (int) spread);
+			graphics_draw_text(ctx, str, font_medium, info_frame, GTextOverflowModeWordWrap, GTextAlignmentRight, NULL);
+		}
 	} else {
 		int h = frame.size.h - 2 * GRAPH_HEIGHT;
 		// line 1: frequency
 		GRect info_frame = GRect(0, 0, frame.size.w, h / 2);
-		snprintf(str, sizeof(str), "%sHz", floatStr(str2, measurement.freq, 2));
+		snprintf(str, sizeof(str), "%sHz", fixedStr(str2, measurement.freq, 2));
 		graphics_draw_text(ctx, text_main_frequency, font_medium, info_frame, GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
 		graphics_draw_text(ctx, str, font_medium, info_frame, GTextOverflowModeWordWrap, GTextAlignmentRight, NULL);
 		// line 2: amplitude
-		snprintf(str, sizeof(str), "\n%s", floatStr(str2, measurement.amp, 2));
+		snprintf(str, sizeof(str), "\n%s", fixedStr(str2, measurement.amp, 2));
 		graphics_draw_text(ctx, text_main_amplitude, font_medium, info_frame, GTextOverflowModeWordWrap, GTextAlignmentLeft, NULL);
 		graphics_draw_text(ctx, str, font_medium, info_frame, GTextOverflowModeWordWrap, GTextAlignmentRight, NULL);
 	}
@@ -157,6 +185,13 @@ static void icon_layer_update_callback(Layer *me, GContext *ctx) {
 	graphics_draw_text(ctx, icon_settings, font_symbols, GRect(0, frame.size.h - 30, frame.size.w, frame.size.w), GTextOverflowModeWordWrap, GTextAlignmentCenter, NULL);
 }
 
+static void main_start_measure(bool keep_measuring) {
+	continuous = keep_measuring;
+	measurement = Measurement(0, 0, 0);
+	measure_set_model(MEASURE_TOLERANCE_DEFAULT, beta[0], beta[1], beta[2]);
+	start_measure(MEASURE_ENGINE_DEFAULT, (MeasureHandler) handle_measure, (FinalMeasureHandler) handle_final);
+}
+
 void click_handler(ClickRecognizerRef recognizer, void *context) {
 	switch (click_recognizer_get_button_id(recognizer)) {
 		case BUTTON_ID_UP:
@@ -173,7 +208,7 @@ void click_handler(ClickRecognizerRef recognizer, void *context) {
 			if (is_measuring())
 				stop_measure();
 			else if (calibrations_count >= 3)
-				start_measure((MeasureHandler) handle_measure, (FinalMeasureHandler) handle_final);
+				main_start_measure(false);
 			layer_mark_dirty(graph_layer);
 			layer_mark_dirty(icon_layer);
 			break;
@@ -181,6 +216,15 @@ void click_handler(ClickRecognizerRef recognizer, void *context) {
 			break;
 	}
 }
+// hold select to keep weighing
+void long_click_handler(ClickRecognizerRef recognizer, void *context) {
+	if (is_measuring())
+		stop_measure();
+	else if (calibrations_count >= 3)
+		main_start_measure(true);
+	layer_mark_dirty(graph_layer);
+	layer_mark_dirty(icon_layer);
+}
 void help_handler_first_steps(ClickRecognizerRef recognizer, void *context) {
 	help_page_close();
 	main_page_open();
@@ -188,6 +232,7 @@ void help_handler_first_steps(ClickRecognizerRef recognizer, void *context) {
 }
 void click_config(Window *window) {
 	window_single_click_subscribe(BUTTON_ID_SELECT, click_handler);
+	window_long_click_subscribe(BUTTON_ID_SELECT, 500, long_click_handler, NULL);
 	window_single_click_subscribe(BUTTON_ID_DOWN, click_handler);
 	window_single_click_subscribe(BUTTON_ID_UP, click_handler);
 }
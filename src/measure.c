@@ -1,155 +1,1393 @@
 #include <pebble.h>
 #include "main.h"
 #include "measure.h"
+#include "sdft.h"
+#include "goertzel.h"
+#include "cic.h"
+#include "yin.h"
+#include "zero_cross.h"
 
-#define SAMPLE_RATE ACCEL_SAMPLING_100HZ
-#define NUM_POINTS (2*SAMPLE_RATE)
+// ACCEL_SAMPLING_100HZ, as a number so the preprocessor checks below can use it
+#define SAMPLE_RATE 100
 #define MAX_VALUE 4500
 
+// the accelerometer stream is decimated by this factor before analysis, select with -DDECIMATION=...
+// hand motion stays below ~5Hz, so 4 (25Hz) keeps the band and cuts the spectrum size by 4
+// the static FFT plans have to be generated for the resulting NUM_POINTS and its longer windows, see wscript
+#ifndef DECIMATION
+#define DECIMATION 4
+#endif
+// order of the CIC decimator, more stages reject aliases better but droop more in the band
+#define CIC_ORDER 3
+#define ANALYSIS_RATE (SAMPLE_RATE / DECIMATION)
+// the spectrum always covers 2 seconds, 2 bins per Hz at any decimation
+#define NUM_POINTS (2*ANALYSIS_RATE)
+#if SAMPLE_RATE % DECIMATION || NUM_POINTS % 2
+#error "DECIMATION must divide the sample rate into an even number of points"
+#endif
+
+// spectrum engines, select with -DSPECTRUM_ENGINE=...
+#define SPECTRUM_FFT	0		// full kiss_fftr every 5th batch
+#define SPECTRUM_SDFT	1		// sliding DFT of the low bins, updated per sample
+#define SPECTRUM_GOERTZEL	2	// Goertzel bank over the hand motion band only, every 5th batch
+#ifndef SPECTRUM_ENGINE
+#define SPECTRUM_ENGINE SPECTRUM_FFT
+#endif
+
+// window applied before the transform, select with -DSPECTRUM_WINDOW=...
+#define WINDOW_NONE	0
+#define WINDOW_HANN	1
+#define WINDOW_BLACKMAN	2
+#ifndef SPECTRUM_WINDOW
+#define SPECTRUM_WINDOW WINDOW_HANN
+#endif
+
+// w[n] = A0 - A1 cos(2pi n/N) + A2 cos(4pi n/N) in Q15, A0 is also the gain at the peak
+#if SPECTRUM_WINDOW == WINDOW_HANN
+#define WINDOW_A0 16384
+#define WINDOW_A1 16384
+#define WINDOW_A2 0
+#define WINDOW_MARGIN 1
+#elif SPECTRUM_WINDOW == WINDOW_BLACKMAN
+#define WINDOW_A0 13763
+#define WINDOW_A1 16384
+#define WINDOW_A2 2621
+#define WINDOW_MARGIN 2
+#else
+#define WINDOW_A0 32768
+#define WINDOW_MARGIN 0
+#endif
+
+// motion signal taken from each sample, select with -DMOTION_SIGNAL=...
+#define MOTION_Z	0				// z axis only
+#define MOTION_GRAVITY	1	// all axes projected onto the tracked gravity direction
+#ifndef MOTION_SIGNAL
+#define MOTION_SIGNAL MOTION_GRAVITY
+#endif
+
+// gravity low pass time constant is 2^GRAVITY_SHIFT samples (2.56s, well below hand motion)
+#define GRAVITY_SHIFT 8
+#define GRAVITY_FRAC 8
+
+// the motion signal is high passed per sample before decimation, select with -DDC_BLOCK=0 to keep the offset
+// y[n] = x[n] - x[n-1] + (1 - 2^-DC_SHIFT) y[n-1] puts the corner at 0.25Hz, which also removes
+// the slow drift of a turning wrist. Its gain in the band is undone on the amplitude with the decimator droop.
+#ifndef DC_BLOCK
+#define DC_BLOCK 1
+#endif
+#define DC_SHIFT 6
+#define DC_FRAC 8
+
+// band of bins evaluated by the Goertzel bank, 2 bins per Hz
+#ifndef GOERTZEL_MIN_BIN
+#define GOERTZEL_MIN_BIN 1
+#endif
+#ifndef GOERTZEL_MAX_BIN
+#define GOERTZEL_MAX_BIN 12
+#endif
+
+// the FFT window grows for slow motion: FFT_LENGTHS transforms of NUM_POINTS << i points
+// (2, 4, 8 seconds), select with -DFFT_LENGTHS=..., wscript generates the plans for them
+#ifndef FFT_LENGTHS
+#define FFT_LENGTHS 3
+#endif
+#if SPECTRUM_ENGINE != SPECTRUM_FFT
+// the sliding DFT and Goertzel bank keep their single length
+#undef FFT_LENGTHS
+#define FFT_LENGTHS 1
+#endif
+#define MAX_POINTS (NUM_POINTS << (FFT_LENGTHS - 1))
+// pick the length so the peak stays within CYCLES_MIN..CYCLES_MAX cycles per window,
+// doubling or halving at the limits leaves it inside again
+#define CYCLES_MIN 3
+#define CYCLES_MAX 8
+#if FFT_LENGTHS > 4
+#error "at most 4 FFT lengths"
+#endif
+#if SPECTRUM_ENGINE == SPECTRUM_FFT && defined(KISS_FFT_STATIC_PLAN)
+// kiss_fftr_alloc has no plan for other lengths and returns NULL
+#include "kiss_fft_plan_sizes.h"
+#if !KISS_FFT_HAS_PLAN(NUM_POINTS) || (FFT_LENGTHS > 1 && !KISS_FFT_HAS_PLAN(NUM_POINTS << 1)) \
+	|| (FFT_LENGTHS > 2 && !KISS_FFT_HAS_PLAN(NUM_POINTS << 2)) || (FFT_LENGTHS > 3 && !KISS_FFT_HAS_PLAN(NUM_POINTS << 3))
+#error "no static FFT plan for a window length, generate it with FFT_SIZES in wscript"
+#endif
+#endif
+
+// the FFT peak is refined by a zoomed DFT over +-1/2 bin around it with PEAK_ZOOM points per bin,
+// select with -DPEAK_ZOOM=..., 0 leaves the interpolated bin position
+#ifndef PEAK_ZOOM
+#define PEAK_ZOOM 8
+#endif
+#if SPECTRUM_ENGINE != SPECTRUM_FFT
+#undef PEAK_ZOOM
+#define PEAK_ZOOM 0
+#endif
+
+// the peak is refined further by the phase it advanced since the last analysis (phase vocoder),
+// select with -DPHASE_ESTIMATE=0 to leave it at the zoomed DFT, needs PEAK_ZOOM
+#ifndef PHASE_ESTIMATE
+#define PHASE_ESTIMATE 1
+#endif
+#if !PEAK_ZOOM
+#undef PHASE_ESTIMATE
+#define PHASE_ESTIMATE 0
+#endif
+// two phase estimates agreeing within 1/PHASE_LOCK bins lock the peak, the final value
+// then needs FINAL_FRAMES_LOCKED frames instead of FINAL_FRAMES
+#define PHASE_LOCK 32
+#define FINAL_FRAMES 3
+#define FINAL_FRAMES_LOCKED 2
+// the final value is the trimmed mean of up to FINAL_WINDOW accepted frames, reported once the
+// 95% confidence interval of the weight is within the tolerance or when they are all there
+// however much they spread, select with -DFINAL_WINDOW=...
+#ifndef FINAL_WINDOW
+#define FINAL_WINDOW 8
+#endif
+// a frame further than FINAL_REJECT scaled median absolute deviations from the median of the
+// frames so far is rejected, select with -DFINAL_REJECT=... The deviation is at least
+// FINAL_FREQ_FLOOR Hz and FINAL_AMP_FLOOR of the amplitude, or a run of equal frames rejects all others.
+#ifndef FINAL_REJECT
+#define FINAL_REJECT 3
+#endif
+#define FINAL_FREQ_FLOOR Q16(0.02)
+#define FINAL_AMP_FLOOR Q16(0.05)
+// a quarter of the frames is trimmed off each end of the mean
+#define FINAL_TRIM 4
+
+// frames are fused by a Kalman filter per quantity, a random walk observed with a noise that
+// shrinks with the amplitude SNR of the frame. It smooths the live values and leaves single
+// glitches out of the final value. Select with -DTRACK_FRAMES=0 to use frames as they are.
+#ifndef TRACK_FRAMES
+#define TRACK_FRAMES 1
+#endif
+// spread of a frame at an amplitude SNR of 1 in Hz and relative to the amplitude, tuned in simulation
+#define TRACK_FREQ_NOISE Q16(0.5)
+#define TRACK_AMP_NOISE Q16(2)
+// drift per frame in Hz and relative to the amplitude
+#define TRACK_FREQ_DRIFT Q16(0.01)
+#define TRACK_AMP_DRIFT Q16(0.02)
+// a frame whose squared innovations over their variances sum above the 99% quantile of chi^2
+// with 2 degrees of freedom is a glitch, TRACK_GLITCHES in a row mean the motion changed
+#define TRACK_GATE Q16(9.2)
+#define TRACK_GLITCHES 2
+
+// the peak is the fundamental with the largest sum over PEAK_HARMONICS of its harmonics, each
+// weighted by 1/sqrt(h), so a strong 2nd harmonic of jerky motion does not win over it.
+// select with -DPEAK_HARMONICS=..., 1 takes the largest bin
+#ifndef PEAK_HARMONICS
+#define PEAK_HARMONICS 3
+#endif
+#if PEAK_HARMONICS > 4
+#error "at most 4 harmonics"
+#endif
+// a fundamental candidate needs at least 1/2^HARMONIC_FLOOR of the largest bin,
+// otherwise noise below a clean peak would collect it as its harmonic
+#define HARMONIC_FLOOR 2
+
+// spectrum bins MIN_BIN..NUM_BINS-1 are analysed, bin 0 only provides the offset
+#if SPECTRUM_ENGINE == SPECTRUM_SDFT
+// bins 0..20 cover 0-10Hz which is plenty for hand motion, less if decimation puts Nyquist below that
+#define MIN_BIN 1
+#define NUM_BINS (NUM_POINTS / 2 + 1 - WINDOW_MARGIN < 21 ? NUM_POINTS / 2 + 1 - WINDOW_MARGIN : 21)
+#elif SPECTRUM_ENGINE == SPECTRUM_GOERTZEL
+#define MIN_BIN GOERTZEL_MIN_BIN
+#define NUM_BINS (GOERTZEL_MAX_BIN + 1)
+#else
+// bins of the longest length, the current one has (NUM_POINTS << fft_length) / 2
+#define MIN_BIN 1
+#define NUM_BINS (MAX_POINTS / 2)
+#endif
+
+// spectrum units are X / NUM_POINTS, or X / 2^exponent for the block floating point FFT
+// (X / (NUM_POINTS << fft_length) for the longer ones, see do_measure)
+#if SPECTRUM_ENGINE == SPECTRUM_FFT && defined(KISS_FFT_BFP)
+#define SPECTRUM_DIV NUM_POINTS
+#else
+#define SPECTRUM_DIV 1
+#endif
+// Q16 amplitude in g per spectrum unit as Q32, also undoing the window gain
+#define AMP_FACTOR ((uint64_t) (MAX_VALUE * (32768.0 / WINDOW_A0) * 281474976710656.0 / (1000.0 * SAMP_MAX * SPECTRUM_DIV) + 0.5))
+
+#define SAMPLE_MASK (SAMPLE_BUFFER_SIZE - 1)
+#if SAMPLE_BUFFER_SIZE < MAX_POINTS || (SAMPLE_BUFFER_SIZE & SAMPLE_MASK)
+#error "SAMPLE_BUFFER_SIZE must be a power of two holding the longest window, reduce FFT_LENGTHS"
+#endif
+
+// YIN compares a window against itself delayed by up to YIN_MAX_LAG samples (1.5s, down to 0.67Hz)
+#define YIN_MAX_LAG (NUM_POINTS * 3 / 4)
+#define YIN_MIN_LAG 2
+#define YIN_WINDOW (SAMPLE_BUFFER_SIZE - YIN_MAX_LAG < YIN_MAX_LAG ? SAMPLE_BUFFER_SIZE - YIN_MAX_LAG : YIN_MAX_LAG)
+#define YIN_THRESHOLD Q16(0.15)
+// the zero crossing tracker averages the periods of the last 4 seconds, its offset follows
+// with a time constant of about 2.5 seconds
+#define ZC_WINDOW (2 * NUM_POINTS < SAMPLE_BUFFER_SIZE ? 2 * NUM_POINTS : SAMPLE_BUFFER_SIZE)
+#define ZC_DC_SHIFT (ANALYSIS_RATE <= 25 ? 6 : ANALYSIS_RATE <= 50 ? 7 : 8)
+// Q16 amplitude in g per sample unit as Q48, half the peak like the spectrum engines report
+#define TONE_AMP_FACTOR ((uint64_t) (MAX_VALUE * 281474976710656.0 / (1000.0 * SAMP_MAX) + 0.5))
+
+// analysis cadence in accelerometer samples at SAMPLE_RATE, hops are multiples of the batch
+#define BATCH_MAX 25		// most samples per accelerometer callback
+#define HOP_FAST 50			// confidence is rising, get to a final value quickly
+#define HOP_DEFAULT 125
+#define HOP_SLOW 250		// no motion or a stable one, save battery
+// frames in a row without signal or with a steady peak before slowing down
+#define HOP_SLOW_FRAMES 3
+// peak SNR in dB below which there is no motion
+#define HOP_SIGNAL MEASURE_SNR_CLEAR
+
+// power ratios are kept down to -20 dB, noise alone leaves none after the floor is taken off
+#define SNR_MIN Q16(0.01)
+
 static bool measure_running;
-static int next_draw;
+static uint16_t hop = HOP_DEFAULT;
+static uint16_t batch = BATCH_MAX;
+static bool hop_adaptive = true;
+// accelerometer samples since the last analysis
+static uint32_t hop_samples;
+// state of the adaptive schedule
+static q16 hop_last_snr;
+// peak position in 1/256 bins of the longest transform
+static int32_t hop_last_f;
+static int hop_quiet_frames;
 
 static kiss_fft_scalar fft_zero;
-static kiss_fftr_cfg fft_cfg;
-static kiss_fft_scalar fft_in[NUM_POINTS];
-static kiss_fft_cpx fft_out[NUM_POINTS];
+#if SPECTRUM_ENGINE == SPECTRUM_SDFT
+static sdft_cfg sdft;
+#elif SPECTRUM_ENGINE == SPECTRUM_GOERTZEL
+static goertzel_cfg goertzel;
+#else
+// one plan per window length
+static kiss_fftr_cfg fft_cfg[FFT_LENGTHS];
+#if SPECTRUM_WINDOW != WINDOW_NONE
+// first half of the symmetric window for the longest length, shorter ones use every 2^k-th value
+static int16_t window_table[MAX_POINTS / 2 + 1];
+#endif
+#endif
+// the window is NUM_POINTS << fft_length samples
+static int fft_length;
+// shift from bins of the current length to bins of the longest one
+#define LENGTH_SHIFT (FFT_LENGTHS - 1 - fft_length)
+// write cursor when measuring started, longer windows need the samples to fill them
+static uint32_t sample_start;
+#if DECIMATION > 1
+static cic_cfg cic;
+#endif
+#define BAND_GAIN (DECIMATION > 1 || DC_BLOCK)
+#if BAND_GAIN
+// decimator and high pass gain per bin of the longest length in Q15, undone on the amplitude of the peak
+static uint16_t band_gain[NUM_BINS];
+#endif
+// sample ring and free running write cursor
+static kiss_fft_scalar samples[SAMPLE_BUFFER_SIZE];
+static uint32_t sample_pos;
+#if MOTION_SIGNAL == MOTION_GRAVITY
+// low passed acceleration with GRAVITY_FRAC fraction bits, seeded from the first sample
+// (scaled by multiplying, left shifts of negative values are undefined)
+static int32_t gravity[3];
+static bool gravity_valid;
+#endif
+#if DC_BLOCK
+// previous input and output with DC_FRAC fraction bits of the high pass, seeded from the first sample
+static int32_t dc_in;
+static int32_t dc_out;
+static bool dc_valid;
+#endif
+#if SPECTRUM_ENGINE == SPECTRUM_FFT
+// the window is transformed in place, up to MAX_POINTS samples in, packed spectrum out
+#define SPECTRUM_SIZE (MAX_POINTS / 2)
+#else
+#define SPECTRUM_SIZE (NUM_BINS + WINDOW_MARGIN)
+#endif
+static kiss_fft_cpx fft_out[SPECTRUM_SIZE];
+// magnitude spectrum, independent of the phase of the motion
+static uint16_t fft_mag[NUM_BINS];
+
+static yin_cfg yin;
+static zero_cross_cfg zero_cross;
+
+// one analysed frame
+typedef struct {
+	SampleView window;
+	kiss_fft_scalar offset;
+	// peak position in 1/256 bins of the longest transform, compared across frames
+	int32_t f;
+	q16 freq;
+	q16 amp;
+	// power of the peak over the noise floor per bin, as the longest transform would see it
+	q16 snr;
+} Estimate;
+
+// analysis engines behind a common interface, start_measure picks one
+typedef struct {
+	const char *name;
+	void (*init)();
+	void (*deinit)();
+	// a new measurement starts
+	void (*reset)();
+	// every decimated sample after it entered the ring, NULL if the engine only reads windows
+	void (*push)(kiss_fft_scalar sample);
+	// accumulate is false for the extra in-between updates of the sliding DFT
+	void (*estimate)(bool accumulate, Estimate *e);
+	// follow the signal after an accumulated frame, NULL to keep the window
+	void (*adapt)(q16 snr, int32_t f);
+	// bytes of working memory besides the sample ring
+	int (*memory)();
+	// estimates after every batch instead of once per hop
+	bool every_batch;
+} Analyzer;
+
+// defined after the engines
+static const Analyzer analyzers[MEASURE_ENGINE_COUNT];
+static const Analyzer *analyzer = &analyzers[MEASURE_ENGINE_DEFAULT];
+// estimates per engine since init_measure
+static uint32_t engine_estimates[MEASURE_ENGINE_COUNT];
+// the benchmark of measure_engine_stats runs estimates back to back for at least this long,
+// so the millisecond clock resolves their cost to within 1/BENCH_MS
+#define BENCH_MS 50
 
 static MeasureHandler callback = NULL;
 static FinalMeasureHandler final_callback = NULL;
 
-static Measurement avg_m;
+// accepted frames of the final value
 static int16_t avg_m_count;
-static float lastAvgF;
+static q16 avg_m_freqs[FINAL_WINDOW];
+static q16 avg_m_amps[FINAL_WINDOW];
+// frames left out of it so far and the counts behind the last final value
+static uint16_t avg_m_rejected, avg_m_skipped;
+static MeasureFinalStats final_stats;
+#if TRACK_FRAMES
+// estimate in Q16 and its variance in Q32
+typedef struct {
+	q16 x;
+	int64_t p;
+} Track;
+static Track track_freq, track_amp;
+static bool track_valid;
+static int track_glitches;
+#endif
+// grams per g of amplitude and per Hz and the offset in grams in Q16, set by measure_set_model
+static int32_t tolerance = MEASURE_TOLERANCE_DEFAULT;
+static q16 model_amp_gain = Q16(-250), model_freq_gain = Q16(-250), model_offset = Q16(1000);
+// half width of the 95% confidence interval of the live weight in grams, -1 without a clear motion
+static int32_t weight_spread = -1;
+#if !TRACK_FRAMES
+// weights of the latest accepted frames, they carry over final values like the tracker does
+static int32_t live_weights[FINAL_WINDOW];
+static int16_t live_count, live_pos;
+static int32_t live_last_f;
+#endif
+// peak position in 1/256 bins of the longest transform
+static int32_t lastAvgF;
+#if PHASE_ESTIMATE
+// phase of the peak at the center of the last analysed window, TRIG_MAX_ANGLE per turn
+static bool phase_valid;
+static uint32_t phase_center;
+static int32_t phase_angle;
+// last phase estimate in 1/256 bins of the longest transform, valid while phase_refined
+static int32_t phase_last_f;
+static bool phase_refined;
+static bool phase_locked;
+#endif
 
 	
-static void do_measure() {
-	// do fft
-	kiss_fftr(fft_cfg, (kiss_fft_scalar*) fft_in, fft_out);
-	
-	kiss_fft_scalar offset = fft_out[0].r;
+// view of the samples in the current window length
+static SampleView current_window() {
+	uint32_t n = NUM_POINTS << fft_length;
+	return (SampleView) { samples, sample_pos - n, n };
+}
+
+#if SPECTRUM_ENGINE == SPECTRUM_FFT
+// copy a window out of the ring in at most two segments
+static void unwrap_samples(SampleView view, kiss_fft_scalar *out) {
+	uint32_t start = view.start & SAMPLE_MASK;
+	uint32_t first = SAMPLE_BUFFER_SIZE - start;
+	if (first >= view.count) {
+		memcpy(out, &samples[start], view.count * sizeof(kiss_fft_scalar));
+	} else {
+		memcpy(out, &samples[start], first * sizeof(kiss_fft_scalar));
+		memcpy(&out[first], samples, (view.count - first) * sizeof(kiss_fft_scalar));
+	}
+}
+#endif
+
+#if SPECTRUM_WINDOW != WINDOW_NONE
+#if SPECTRUM_ENGINE == SPECTRUM_FFT
+static void init_window() {
+	for (int i = 0; i <= MAX_POINTS / 2; i++) {
+		int32_t c1 = cos_lookup(TRIG_MAX_ANGLE * i / MAX_POINTS);
+		int32_t c2 = cos_lookup(2 * TRIG_MAX_ANGLE * i / MAX_POINTS);
+		int32_t w = WINDOW_A0 - WINDOW_A1 * c1 / TRIG_MAX_RATIO + WINDOW_A2 * c2 / TRIG_MAX_RATIO;
+		window_table[i] = w > SAMP_MAX ? SAMP_MAX : w;
+	}
+}
+
+// remove the mean and window the samples in place, returns the mean
+// the mean has to go first or gravity leaks into the lowest bins through the window
+static kiss_fft_scalar apply_window(kiss_fft_scalar *data, int n) {
+	int32_t sum = 0;
+	for (int i = 0; i < n; i++)
+		sum += data[i];
+	kiss_fft_scalar mean = sum / n;
+	for (int i = 0; i < n; i++) {
+		int32_t w = window_table[(i <= n / 2 ? i : n - i) << LENGTH_SHIFT];
+		int32_t val = ((data[i] - mean) * w + (1 << (FRACBITS - 1))) >> FRACBITS;
+		if (val > SAMP_MAX) val = SAMP_MAX;
+		if (val < -SAMP_MAX) val = -SAMP_MAX;
+		data[i] = val;
+	}
+	return mean;
+}
+#else
+// the sliding and Goertzel spectra are rectangular, apply the window as a convolution with
+// the neighbouring bins instead. X[-k] = conj(X[k]) for bins below 0 and the mean is
+// left out so gravity does not leak into the lowest bins.
+static const kiss_fft_cpx fft_zero_cpx;
+static kiss_fft_cpx window_bin(int k) {
+	if (k == 0)
+		return fft_zero_cpx;
+	kiss_fft_cpx c = fft_out[k < 0 ? -k : k];
+	if (k < 0)
+		c.i = -c.i;
+	return c;
+}
+static void window_spectrum() {
+	kiss_fft_cpx windowed[NUM_BINS];
+	for (int k = MIN_BIN; k < NUM_BINS; k++) {
+		kiss_fft_cpx c = window_bin(k), l1 = window_bin(k - 1), r1 = window_bin(k + 1);
+		int32_t re = WINDOW_A0 * c.r - WINDOW_A1 / 2 * (l1.r + r1.r);
+		int32_t im = WINDOW_A0 * c.i - WINDOW_A1 / 2 * (l1.i + r1.i);
+#if WINDOW_A2 != 0
+		kiss_fft_cpx l2 = window_bin(k - 2), r2 = window_bin(k + 2);
+		re += WINDOW_A2 / 2 * (l2.r + r2.r);
+		im += WINDOW_A2 / 2 * (l2.i + r2.i);
+#endif
+		windowed[k].r = (re + (1 << (FRACBITS - 1))) >> FRACBITS;
+		windowed[k].i = (im + (1 << (FRACBITS - 1))) >> FRACBITS;
+	}
+	memcpy(&fft_out[MIN_BIN], &windowed[MIN_BIN], (NUM_BINS - MIN_BIN) * sizeof(kiss_fft_cpx));
+}
+#endif
+#endif
+
+// offset of the peak at bin k from log magnitudes of its neighbours (gaussian fit), in 1/256 bins
+static int32_t interpolate_peak(int k, int bins) {
+	if (k <= MIN_BIN || k >= bins - 1)
+		return 0;
+	int32_t l = int_log2(fft_mag[k - 1] + 1), c = int_log2(fft_mag[k] + 1), r = int_log2(fft_mag[k + 1] + 1);
+	int32_t den = 2 * (2 * c - l - r);
+	if (den <= 0)
+		return 0;
+	int32_t d = (r - l) * 256 / den;
+	if (d > 128) d = 128;
+	if (d < -128) d = -128;
+	return d;
+}
+
+#if PEAK_HARMONICS > 1
+// 1/sqrt(h) in Q8
+static const uint16_t harmonic_weight[] = { 256, 256, 181, 148, 128 };
+
+// bin of the fundamental with the largest weighted harmonic sum, climbed to the local maximum
+// the fundamental may sit between bins, harmonic h is taken as the largest bin within +-1 of h*k
+static int harmonic_peak(int maxF, uint16_t max, int bins) {
+	int best = maxF;
+	uint32_t best_score = 0;
+	for (int k = MIN_BIN; k <= maxF; k++) {
+		if (fft_mag[k] < max >> HARMONIC_FLOOR)
+			continue;
+		uint32_t score = fft_mag[k] * harmonic_weight[1];
+		for (int h = 2; h <= PEAK_HARMONICS && h * k - 1 < bins; h++) {
+			uint16_t m = 0;
+			for (int i = h * k - 1; i <= h * k + 1 && i < bins; i++)
+				if (fft_mag[i] > m)
+					m = fft_mag[i];
+			score += m * harmonic_weight[h];
+		}
+		if (score > best_score) {
+			best_score = score;
+			best = k;
+		}
+	}
+	while (best > MIN_BIN && fft_mag[best - 1] > fft_mag[best])
+		best--;
+	while (best + 1 < bins && fft_mag[best + 1] > fft_mag[best])
+		best++;
+	return best;
+}
+#endif
+
+// power ratio in Q16 to dB
+static q16 snr_db(q16 ratio) {
+	return q16_mul(int_log2(ratio) - (16 << 16), Q16(3.01029996));
+}
+
+static void set_hop(uint16_t samples) {
+	// keep hops a multiple of the batch so analysis lands on a callback
+	hop = (samples + batch - 1) / batch * batch;
+}
+
+// pick the next hop from the last analysed frame, peak position in 1/256 bins of the longest transform
+static void adapt_hop(q16 snr, int32_t avgF) {
+	bool stable = abs(avgF - hop_last_f) <= 256 << LENGTH_SHIFT;
+	if (snr < HOP_SIGNAL || (stable && snr <= hop_last_snr))
+		hop_quiet_frames++;
+	else
+		hop_quiet_frames = 0;
+	if (hop_quiet_frames >= HOP_SLOW_FRAMES)
+		set_hop(HOP_SLOW);
+	else if (snr >= HOP_SIGNAL && snr > hop_last_snr)
+		set_hop(HOP_FAST);
+	else
+		set_hop(HOP_DEFAULT);
+	hop_last_snr = snr;
+	hop_last_f = avgF;
+}
+
+#if PEAK_ZOOM
+// single DFT term at a fractional bin (1/256 bins) of the windowed view, scaled down by 2^8,
+// evaluated straight from the sample ring since the FFT input was overwritten.
+// The phase is taken at the center of the window, where the symmetric window adds none.
+static void zoom_dft(SampleView view, kiss_fft_scalar mean, int32_t bin, int64_t *out_re, int64_t *out_im) {
+	const int n = view.count;
+	// bin / 256 turns per window, as 1/2^32 turns per sample
+	uint32_t step = (uint32_t) (((uint64_t) bin << 24) / n), phase = -step * (n / 2);
+	int64_t re = 0, im = 0;
+	for (int i = 0; i < n; i++, phase += step) {
+		int32_t x = sample_view_get(view, i) - mean;
+#if SPECTRUM_WINDOW != WINDOW_NONE
+		x = (x * window_table[(i <= n / 2 ? i : n - i) << LENGTH_SHIFT]) >> FRACBITS;
+#endif
+		int32_t angle = phase >> 16;
+		re += (int64_t) x * cos_lookup(angle);
+		im -= (int64_t) x * sin_lookup(angle);
+	}
+	*out_re = re >> 8;
+	*out_im = im >> 8;
+}
+
+// log2 of the power at a fractional bin (1/256 bins) in Q16
+static int32_t zoom_log_power(SampleView view, kiss_fft_scalar mean, int32_t bin) {
+	int64_t re, im;
+	zoom_dft(view, mean, bin, &re, &im);
+	uint64_t p = (uint64_t) (re * re) + (uint64_t) (im * im);
+	int shift = 0;
+	while (p >> 32) {
+		p >>= 1;
+		shift++;
+	}
+	return int_log2(p) + (shift << 16);
+}
+
+// peak position in 1/256 bins from the maximum of a zoomed DFT around the coarse one
+static int32_t zoom_peak(SampleView view, kiss_fft_scalar mean, int32_t bin) {
+	const int32_t step = 256 / PEAK_ZOOM;
+	int32_t power[PEAK_ZOOM + 1];
+	int best = 0;
+	for (int d = 0; d <= PEAK_ZOOM; d++) {
+		power[d] = zoom_log_power(view, mean, bin + (d - PEAK_ZOOM / 2) * step);
+		if (power[d] > power[best])
+			best = d;
+	}
+	int32_t peak = bin + (best - PEAK_ZOOM / 2) * step;
+	// gaussian fit between the grid points like interpolate_peak
+	if (best > 0 && best < PEAK_ZOOM) {
+		int32_t l = power[best - 1], c = power[best], r = power[best + 1];
+		int32_t den = 2 * (2 * c - l - r);
+		if (den > 0)
+			peak += (int32_t) ((int64_t) (r - l) * step / den);
+	}
+	return peak;
+}
+#endif
+
+#if PHASE_ESTIMATE
+// peak position in 1/256 bins from the phase it advanced since the last analysed window.
+// A sinusoid turns by f * d between window centers d samples apart, the zoomed estimate
+// only has to be close enough to pick the right number of whole turns, within 1/(2d) cycles
+// per sample. The fraction of the turn then resolves f to a small part of a bin.
+static int32_t phase_peak(SampleView view, kiss_fft_scalar mean, int32_t bin, q16 snr) {
+	int64_t re, im;
+	zoom_dft(view, mean, bin, &re, &im);
+	// scale into the range of atan2_lookup, the angle only depends on the ratio
+	while (re > INT16_MAX || re < -INT16_MAX || im > INT16_MAX || im < -INT16_MAX) {
+		re >>= 1;
+		im >>= 1;
+	}
+	int32_t angle = atan2_lookup(im, re);
+	uint32_t center = view.start + view.count / 2;
+	int32_t peak = bin;
+	bool refined = false;
+	uint32_t d = center - phase_center;
+	if (phase_valid && snr >= HOP_SIGNAL && d > 0 && d < SAMPLE_BUFFER_SIZE) {
+		// bin / 256 turns per window over d samples, in 1/TRIG_MAX_ANGLE turns
+		int32_t predicted = (int32_t) (((int64_t) bin * d << 8) / (int32_t) view.count);
+		// what is left of the measured turn, wrapped to +- 1/2 turn
+		int32_t dev = ((angle - phase_angle - predicted + TRIG_MAX_ANGLE / 2) & (TRIG_MAX_ANGLE - 1)) - TRIG_MAX_ANGLE / 2;
+		int32_t delta = (int32_t) ((int64_t) dev * (int32_t) view.count / (int32_t) (d << 8));
+		// further off than the zoomed DFT could be, the signal changed in between
+		if (abs(delta) <= 128) {
+			peak = bin + delta;
+			refined = true;
+		}
+	}
+	int32_t f = peak << LENGTH_SHIFT;
+	phase_locked = refined && phase_refined && abs(f - phase_last_f) <= (256 / PHASE_LOCK) << LENGTH_SHIFT;
+	phase_refined = refined;
+	phase_last_f = f;
+	phase_valid = true;
+	phase_center = center;
+	phase_angle = angle;
+	return peak;
+}
+#endif
+
+#if FFT_LENGTHS > 1
+// grow or shrink the window so a clear peak has CYCLES_MIN..CYCLES_MAX cycles in it,
+// peak position in 1/256 bins of the longest transform
+static void adapt_length(q16 snr, int32_t avgF) {
+	if (snr < HOP_SIGNAL)
+		return;
+	// bins of the current length are cycles per window
+	int32_t cycles = avgF >> LENGTH_SHIFT;
+	int length = fft_length;
+	if (cycles < CYCLES_MIN << 8 && fft_length < FFT_LENGTHS - 1 && sample_pos - sample_start >= (uint32_t) NUM_POINTS << (fft_length + 1))
+		length++;
+	else if (cycles >= CYCLES_MAX << 8 && fft_length > 0)
+		length--;
+	// frames of different lengths are not averaged together
+	if (length != fft_length)
+		avg_m_count = 0;
+	fft_length = length;
+}
+#endif
+
+static void spectrum_estimate(bool accumulate, Estimate *e) {
+	SampleView window = current_window();
+	kiss_fft_scalar offset;
+	int exponent = 0;
+	int bins = NUM_BINS;
+#if SPECTRUM_ENGINE == SPECTRUM_FFT
+	// do fft, bin 0 holds DC and Nyquist afterwards which are not analysed
+	kiss_fft_scalar *fft_in = (kiss_fft_scalar*) fft_out;
+	bins = window.count / 2;
+	unwrap_samples(window, fft_in);
+#if SPECTRUM_WINDOW != WINDOW_NONE
+	offset = apply_window(fft_in, window.count);
+#endif
+	// block floating point keeps small motions at full precision as X / 2^exponent
+	exponent = kiss_fftr_inplace(fft_cfg[fft_length], fft_in);
+#ifdef KISS_FFT_BFP
+	// AMP_FACTOR divides by NUM_POINTS only
+	exponent -= fft_length;
+#endif
+#if SPECTRUM_WINDOW == WINDOW_NONE
+	offset = exponent >= 0 ? fft_out[0].r * (1 << exponent) / SPECTRUM_DIV : (fft_out[0].r >> -exponent) / SPECTRUM_DIV;
+#endif
+#else
+#if SPECTRUM_ENGINE == SPECTRUM_SDFT
+	sdft_spectrum(sdft, fft_out);
+#else
+	goertzel_spectrum(goertzel, samples, SAMPLE_MASK, window.start, fft_out);
+#endif
+	offset = fft_out[0].r;
+#if SPECTRUM_WINDOW != WINDOW_NONE
+	window_spectrum();
+#endif
+#endif
 		
 	// get scale
 	int maxF = 0, avg = 0;
-	kiss_fft_scalar max = 0, pt;
-	for (int i = 0; i < (NUM_POINTS / 2); i++) {
-		pt = fft_out[i].r;
-		if (pt < 0) {
-			pt = -pt;
-			fft_out[i].r = pt;
-		}
-		if (i == 0) continue;
+	uint16_t max = 0, pt;
+	for (int i = MIN_BIN; i < bins; i++) {
+		pt = cpx_mag(fft_out[i].r, fft_out[i].i);
+		fft_mag[i] = pt;
 		avg += pt;
 		if (pt > max) {
 			max = pt;
 			maxF = i;
 		}
 	}
-	avg /= (NUM_POINTS/2 - 1);
+	avg /= (bins - MIN_BIN);
+	// an all zero spectrum, e.g. a watch lying still once the DC blocker settled, has no peak
+	if (maxF < MIN_BIN) {
+		*e = (Estimate) { window, offset, 0, 0, 0, SNR_MIN };
+		return;
+	}
+#if PEAK_HARMONICS > 1
+	maxF = harmonic_peak(maxF, max, bins);
+	max = fft_mag[maxF];
+#endif
 	
-	// adjust the maximum to the best value within a range of +- 3
+	// power of the peak within a range of +- 2, the main lobe of the window
 	int mini = maxF - 2, maxi = maxF + 2;
-	if (mini < 1) mini = 1;
-	if (maxi >= NUM_POINTS / 2) maxi = NUM_POINTS/2 - 1;
-	float sum = 0, avgF = 0;
-	for (int i = mini; i < maxi; i++) {
-		sum += (float) fft_out[i].r;
-		avgF += i * (float) fft_out[i].r;
-	}
-	avgF /= sum;
-	float outerSum = 0;
-	for (int i = 1; i < mini; i++)
-		outerSum += (float) fft_out[i].r;
-	for (int i = maxi + 1; i < NUM_POINTS / 2; i++)
-		outerSum += (float) fft_out[i].r;
-
-	// frequency is: (sampling_rate/2) * maxF / NUM_POINTS
-	float freq = (float)(SAMPLE_RATE * avgF) / (2 * NUM_POINTS);
-	float amp = (float) max * (MAX_VALUE / (1000.0 * SAMP_MAX));
-	float confidence = sum / outerSum;
+	if (mini < MIN_BIN) mini = MIN_BIN;
+	if (maxi >= bins) maxi = bins - 1;
+	uint64_t power = 0;
+	for (int i = mini; i <= maxi; i++)
+		power += (uint32_t) fft_mag[i] * fft_mag[i];
+	// sub-bin position of the peak in 1/256 bins
+	int32_t avgF = (maxF << 8) + interpolate_peak(maxF, bins);
+#if PEAK_ZOOM
+	if (maxF > 0)
+		avgF = zoom_peak(window, offset, avgF);
+#endif
+	// noise floor from the median of the outer bins, which the harmonics of the peak or
+	// a second motion cannot pull up like they did the mean. The spectrum itself is done with,
+	// its memory holds the outer bins for the selection.
+	uint16_t *outer = (uint16_t*) fft_out;
+	int n = 0;
+	for (int i = MIN_BIN; i < bins; i++) {
+		if (i >= mini && i <= maxi)
+			continue;
+#if PEAK_HARMONICS > 1
+		int h = (i + maxF / 2) / maxF;
+		if (h >= 2 && h <= PEAK_HARMONICS && abs(i - h * maxF) <= 1)
+			continue;
+#endif
+		outer[n++] = fft_mag[i];
+	}
+	uint32_t floor = n > 0 ? select_kth(outer, n, n / 2) : 0;
+	// noise magnitudes are Rayleigh distributed with a mean power of median^2 / ln 2. The main
+	// lobe holds the power of a sinusoid whatever the window, less the noise in its bins.
+	// The ratio grows with the length of the transform, scale it to the longest.
+	uint64_t noise = floor > 0 ? (uint64_t) floor * floor : 1;
+	int64_t ratio = div_q((int64_t) power * Q16(0.69314718), noise, 0) - (int64_t) (maxi - mini + 1) * Q16_ONE;
+	ratio = ratio * (MAX_POINTS / (int32_t) window.count);
+	q16 snr = ratio < SNR_MIN ? SNR_MIN : ratio > INT32_MAX ? INT32_MAX : ratio;
+#if PHASE_ESTIMATE
+	if (maxF > 0 && accumulate)
+		avgF = phase_peak(window, offset, avgF, snr_db(snr));
+#endif
+
+	// frequency is: (sampling_rate/2) * maxF / window length, exact in Q16 for 2 bins per Hz
+	q16 freq = avgF * (ANALYSIS_RATE << 8) / (int32_t) (2 * window.count);
+	// undo the window gain so amplitudes stay comparable, within 1 LSB of Q16
+	uint64_t scaled = (uint64_t) max * AMP_FACTOR;
+	scaled = exponent >= 0 ? scaled << exponent : scaled >> -exponent;
+	q16 amp = (scaled + (1ULL << 31)) >> 32;
+#if BAND_GAIN
+	// and the decimator droop and high pass, so calibrations do not depend on them
+	amp = ((int64_t) amp << 15) / band_gain[maxF << LENGTH_SHIFT];
+#endif
+	// compare peaks across lengths in bins of the longest one
+	avgF <<= LENGTH_SHIFT;
+	*e = (Estimate) { window, offset, avgF, freq, amp, snr };
+}
+
+static void spectrum_init() {
+	// the rectangular engines need extra bins on both sides of the band for windowing
+#if SPECTRUM_ENGINE == SPECTRUM_SDFT
+	sdft = sdft_alloc(NUM_POINTS, NUM_BINS + WINDOW_MARGIN);
+#elif SPECTRUM_ENGINE == SPECTRUM_GOERTZEL
+	goertzel = goertzel_alloc(NUM_POINTS, MIN_BIN > WINDOW_MARGIN ? MIN_BIN - WINDOW_MARGIN : 1, NUM_BINS - 1 + WINDOW_MARGIN);
+#else
+	for (int i = 0; i < FFT_LENGTHS; i++)
+		fft_cfg[i] = kiss_fftr_alloc(NUM_POINTS << i, 0, 0, 0);
+#if SPECTRUM_WINDOW != WINDOW_NONE
+	init_window();
+#endif
+#endif
+}
+
+static void spectrum_deinit() {
+#if SPECTRUM_ENGINE == SPECTRUM_SDFT
+	sdft_free(sdft);
+#elif SPECTRUM_ENGINE == SPECTRUM_GOERTZEL
+	goertzel_free(goertzel);
+#else
+	for (int i = 0; i < FFT_LENGTHS; i++)
+		kiss_fftr_free(fft_cfg[i]);
+#endif
+}
+
+static void spectrum_reset() {
+	fft_length = 0;
+#if SPECTRUM_ENGINE == SPECTRUM_SDFT
+	// samples were not pushed while another engine ran, refill from the window
+	sdft_reset(sdft);
+	for (int i = 0; i < NUM_POINTS; i++)
+		sdft_push(sdft, samples[(sample_pos - NUM_POINTS + i) & SAMPLE_MASK], 0);
+#endif
+#if PHASE_ESTIMATE
+	phase_valid = false;
+	phase_refined = false;
+	phase_locked = false;
+#endif
+}
+
+#if SPECTRUM_ENGINE == SPECTRUM_SDFT
+static void spectrum_push(kiss_fft_scalar sample) {
+	// slide the spectrum, dropping the sample that leaves the window
+	sdft_push(sdft, sample, samples[(sample_pos - 1 - NUM_POINTS) & SAMPLE_MASK]);
+}
+#endif
+
+static int spectrum_memory() {
+	int bytes = sizeof(fft_out) + sizeof(fft_mag);
+#if SPECTRUM_ENGINE == SPECTRUM_FFT && SPECTRUM_WINDOW != WINDOW_NONE
+	bytes += sizeof(window_table);
+#endif
+	return bytes;
+}
+
+// frequency, amplitude and offset of a time domain period estimate in 1/256 samples
+// the amplitude is a single DFT term over the whole periods at the end of the view,
+// which leaves out the harmonics like the spectrum peak does
+static void tone_estimate(SampleView view, int32_t period, q16 snr, Estimate *e) {
+	int32_t sum = 0;
+	for (uint32_t i = 0; i < view.count; i++)
+		sum += sample_view_get(view, i);
+	kiss_fft_scalar mean = sum / (int32_t) view.count;
+	*e = (Estimate) { view, mean, 0, 0, 0, SNR_MIN };
+	if (period < 2 << 8)
+		return;
+	// cycles per longest window
+	e->f = ((int64_t) MAX_POINTS << 16) / period;
+	e->freq = e->f * (ANALYSIS_RATE << 8) / (2 * MAX_POINTS);
+	e->snr = snr;
+	uint32_t periods = ((view.count << 8) / period);
+	uint32_t m = periods > 0 ? (periods * period + 128) >> 8 : view.count;
+	if (m > view.count)
+		m = view.count;
+	// 1 / period turns per sample as 1/2^32 turns
+	uint32_t step = (uint32_t) ((1ULL << 40) / period), phase = 0;
+	int64_t re = 0, im = 0;
+	for (uint32_t i = view.count - m; i < view.count; i++, phase += step) {
+		int32_t x = sample_view_get(view, i) - mean;
+		int32_t angle = phase >> 16;
+		re += (int64_t) x * cos_lookup(angle);
+		im -= (int64_t) x * sin_lookup(angle);
+	}
+	re /= TRIG_MAX_RATIO;
+	im /= TRIG_MAX_RATIO;
+	int shift = 0;
+	while (re > 32768 || re < -32768 || im > 32768 || im < -32768) {
+		re >>= 1;
+		im >>= 1;
+		shift++;
+	}
+	uint64_t scaled = ((uint64_t) cpx_mag(re, im) << shift) * TONE_AMP_FACTOR / m;
+	e->amp = (scaled + (1ULL << 31)) >> 32;
+#if BAND_GAIN
+	int bin = (e->f + 128) >> 8;
+	if (bin >= MIN_BIN && bin < NUM_BINS)
+		e->amp = ((int64_t) e->amp << 15) / band_gain[bin];
+#endif
+}
+
+static void yin_init() {
+	yin = yin_alloc(YIN_WINDOW, YIN_MIN_LAG, YIN_MAX_LAG, YIN_THRESHOLD);
+}
+static void yin_deinit() {
+	yin_free(yin);
+}
+static void yin_estimate(bool accumulate, Estimate *e) {
+	SampleView view = { samples, sample_pos - YIN_WINDOW - YIN_MAX_LAG, YIN_WINDOW + YIN_MAX_LAG };
+	int32_t aperiodicity;
+	int32_t period = yin_period(yin, samples, SAMPLE_MASK, view.start, &aperiodicity);
+	// d' at the period is the noise power over the noise and the signal power, which the
+	// longest transform would see MAX_POINTS / 2 times better in its peak bin
+	q16 ratio = div_q(Q16_ONE - aperiodicity, aperiodicity > 0 ? aperiodicity : 1, 16);
+	if (ratio > Q16(256))
+		ratio = Q16(256);
+	tone_estimate(view, period, ratio * (MAX_POINTS / 2), e);
+}
+static int yin_engine_memory() {
+	return yin_memory(yin);
+}
+
+static void zero_cross_init() {
+	zero_cross = zero_cross_alloc(ZC_DC_SHIFT);
+}
+static void zero_cross_deinit() {
+	zero_cross_free(zero_cross);
+}
+static void zero_cross_engine_reset() {
+	zero_cross_reset(zero_cross);
+}
+static void zero_cross_engine_push(kiss_fft_scalar sample) {
+	zero_cross_push(zero_cross, sample);
+}
+static void zero_cross_estimate(bool accumulate, Estimate *e) {
+	SampleView view = { samples, sample_pos - ZC_WINDOW, ZC_WINDOW };
+	int32_t jitter;
+	int32_t period = zero_cross_period(zero_cross, ZC_WINDOW, &jitter);
+	// noise moves a crossing of a sinusoid by 1 / (2 pi sqrt(2 SNR)) periods, the spread
+	// of the period between two of them by 1 / (2 pi sqrt(SNR)). The SNR is scaled like YIN's.
+	int64_t x = q16_mul(jitter > 0 ? jitter : 1, Q16(6.28318531));
+	q16 ratio = x > 0 ? div_q(1LL << 48, x * x, 0) : Q16(256);
+	if (ratio > Q16(256))
+		ratio = Q16(256);
+	tone_estimate(view, period, ratio * (MAX_POINTS / 2), e);
+}
+static int zero_cross_engine_memory() {
+	return zero_cross_memory(zero_cross);
+}
+
+static const Analyzer analyzers[MEASURE_ENGINE_COUNT] = {
+	[MEASURE_ENGINE_SPECTRUM] = {
+		.name = "spectrum", .init = spectrum_init, .deinit = spectrum_deinit, .reset = spectrum_reset,
+#if SPECTRUM_ENGINE == SPECTRUM_SDFT
+		.push = spectrum_push, .every_batch = true,
+#endif
+#if FFT_LENGTHS > 1
+		.adapt = adapt_length,
+#endif
+		.estimate = spectrum_estimate, .memory = spectrum_memory,
+	},
+	[MEASURE_ENGINE_YIN] = {
+		.name = "yin", .init = yin_init, .deinit = yin_deinit,
+		.estimate = yin_estimate, .memory = yin_engine_memory,
+	},
+	[MEASURE_ENGINE_ZERO_CROSSING] = {
+		.name = "zero crossing", .init = zero_cross_init, .deinit = zero_cross_deinit, .reset = zero_cross_engine_reset,
+		.push = zero_cross_engine_push, .estimate = zero_cross_estimate, .memory = zero_cross_engine_memory,
+	},
+};
+
+static uint32_t now_ms() {
+	time_t seconds;
+	uint16_t ms;
+	time_ms(&seconds, &ms);
+	return (uint32_t) seconds * 1000 + ms;
+}
+
+// microseconds per estimate of an engine over the current sample ring, in-between estimates
+// leave the state of the measurement alone
+static uint32_t benchmark_us(const Analyzer *a) {
+	Estimate e;
+	// start on a tick so no partial millisecond is counted
+	uint32_t started = now_ms(), elapsed, count = 0;
+	while (now_ms() == started)
+		;
+	started = now_ms();
+	do {
+		a->estimate(false, &e);
+		count++;
+		elapsed = now_ms() - started;
+	} while (elapsed < BENCH_MS);
+	return elapsed * 1000 / count;
+}
+
+// two-sided 95% quantile of Student's t for n - 1 degrees of freedom in Q8, 2 from 11 frames on
+static const uint16_t student_t[] = { 0, 0, 3253, 1103, 814, 711, 657, 624, 603, 587, 576 };
+
+// n / d rounded to the nearest integer
+static int32_t div_round(int32_t n, int32_t d) {
+	return (n + (n < 0 ? -d / 2 : d / 2)) / d;
+}
+
+// insertion sort, the final window is small
+static void sort_q16(q16 *values, int n) {
+	for (int i = 1; i < n; i++) {
+		q16 v = values[i];
+		int j = i;
+		for (; j > 0 && values[j - 1] > v; j--)
+			values[j] = values[j - 1];
+		values[j] = v;
+	}
+}
+
+static q16 median_sorted(const q16 *sorted, int n) {
+	return n & 1 ? sorted[n / 2] : sorted[n / 2 - 1] + (sorted[n / 2] - sorted[n / 2 - 1]) / 2;
+}
+
+// whether v is within FINAL_REJECT scaled median absolute deviations of the median of n values
+static bool final_inlier(const q16 *values, int n, q16 v, q16 floor) {
+	q16 sorted[FINAL_WINDOW];
+	memcpy(sorted, values, n * sizeof(q16));
+	sort_q16(sorted, n);
+	q16 median = median_sorted(sorted, n);
+	for (int i = 0; i < n; i++)
+		sorted[i] = abs(values[i] - median);
+	sort_q16(sorted, n);
+	// 1.4826 MAD estimates the standard deviation of normally distributed frames
+	q16 deviation = q16_mul(median_sorted(sorted, n), Q16(1.4826));
+	if (deviation < floor)
+		deviation = floor;
+	return abs(v - median) <= q16_mul(deviation, Q16(FINAL_REJECT));
+}
+
+// mean of n values without the lowest and highest n / FINAL_TRIM
+static q16 trimmed_mean(const q16 *values, int n) {
+	q16 sorted[FINAL_WINDOW];
+	memcpy(sorted, values, n * sizeof(q16));
+	sort_q16(sorted, n);
+	int trim = n / FINAL_TRIM;
+	int32_t sum = 0;
+	for (int i = trim; i < n - trim; i++)
+		sum += sorted[i];
+	return div_round(sum, n - 2 * trim);
+}
+
+// var(w) = ga^2 var(amp) + 2 ga gf cov(amp, freq) + gf^2 var(freq) in grams^2 Q16 from Q32
+// (co)variances for the gains of the weight model
+static int64_t weight_var(int64_t ff, int64_t aa, int64_t fa) {
+	// one gain at a time in Q8 so any model fits 64 bits
+	int64_t ga = model_amp_gain >> 8, gf = model_freq_gain >> 8;
+	aa = ((aa >> 16) * ga >> 8) * ga;
+	ff = ((ff >> 16) * gf >> 8) * gf;
+	fa = ((fa >> 16) * ga >> 8) * gf;
+	return (aa + ff + 2 * fa) >> 8;
+}
+
+// weight in grams of the model
+static int32_t model_weight(q16 freq, q16 amp) {
+	int64_t w = (int64_t) model_amp_gain * amp + (int64_t) model_freq_gain * freq + ((int64_t) model_offset << 16);
+	return (w + (1LL << 31)) >> 32;
+}
+
+#if !TRACK_FRAMES
+// spread of the mean weight of the latest accepted frames, peak position in 1/256 bins of the longest transform
+static int32_t live_spread(int32_t avgF, int32_t weight) {
+	// a peak that moved by a bin is a new motion
+	if (live_count > 0 && abs(avgF - live_last_f) > 256 << LENGTH_SHIFT)
+		live_count = 0;
+	live_last_f = avgF;
+	live_weights[live_pos] = weight;
+	live_pos = (live_pos + 1) % FINAL_WINDOW;
+	if (live_count < FINAL_WINDOW)
+		live_count++;
+	int n = live_count;
+	if (n < 2)
+		return -1;
+	int32_t mean = 0;
+	for (int i = 0; i < n; i++)
+		mean += live_weights[(live_pos - 1 - i + FINAL_WINDOW) % FINAL_WINDOW];
+	mean = div_round(mean, n);
+	int64_t ss = 0;
+	for (int i = 0; i < n; i++) {
+		int64_t d = live_weights[(live_pos - 1 - i + FINAL_WINDOW) % FINAL_WINDOW] - mean;
+		ss += d * d;
+	}
+	// variance of the mean in grams^2 Q16, the root in Q8 times t in Q8
+	int64_t var = (ss << 16) / (n * (n - 1));
+	int64_t t = n < (int) (sizeof(student_t) / sizeof(student_t[0])) ? student_t[n] : 512;
+	return ((int64_t) int_sqrt(var < UINT32_MAX ? var : UINT32_MAX) * t + (1 << 15)) >> 16;
+}
+#endif
+
+// whether an interval of t (Q8) standard deviations of var (grams^2 Q16) is within the tolerance
+static bool weight_within_tolerance(int64_t var, int64_t t) {
+	return var <= ((int64_t) tolerance * tolerance << 32) / (t * t);
+}
+
+// whether the mean weight of the accepted frames is known within the tolerance
+static bool final_within_tolerance() {
+	int n = avg_m_count;
+	if (n < 2)
+		return false;
+	// sums of products of the deviations from the means in Q32
+	int32_t mf = 0, ma = 0;
+	for (int i = 0; i < n; i++) {
+		mf += avg_m_freqs[i];
+		ma += avg_m_amps[i];
+	}
+	mf = div_round(mf, n);
+	ma = div_round(ma, n);
+	int64_t ff = 0, aa = 0, fa = 0;
+	for (int i = 0; i < n; i++) {
+		int64_t df = avg_m_freqs[i] - mf, da = avg_m_amps[i] - ma;
+		ff += df * df;
+		aa += da * da;
+		fa += df * da;
+	}
+	int64_t t = n < (int) (sizeof(student_t) / sizeof(student_t[0])) ? student_t[n] : 512;
+	if (weight_within_tolerance(weight_var(ff, aa, fa) / (n * (n - 1)), t))
+		return true;
+#if TRACK_FRAMES
+	// the tracked estimate weighs frames by their confidence and may know it sooner, 1.96 deviations
+	if (weight_within_tolerance(weight_var(track_freq.p, track_amp.p, 0), 502))
+		return true;
+#endif
+	return false;
+}
+
+#if TRACK_FRAMES
+static void track_seed(Track *t, q16 z, int64_t r) {
+	t->x = z;
+	t->p = r;
+}
+
+// add the drift of a frame, returns the squared innovation of z over its variance in Q16
+static int64_t track_predict(Track *t, q16 z, int64_t r, int64_t q) {
+	t->p += q;
+	int64_t nu = z - t->x;
+	return div_q(nu * nu, t->p + r, 16);
+}
+
+static void track_update(Track *t, q16 z, int64_t r) {
+	int32_t k = div_q(t->p, t->p + r, 16);
+	t->x += q16_mul(k, z - t->x);
+	t->p -= (t->p * k) >> 16;
+}
+
+// fuse a frame into the tracked motion, false for a glitch that is left out
+static bool track_frame(q16 freq, q16 amp, q16 confidence) {
+	q16 sf = div_q(TRACK_FREQ_NOISE, confidence, 16), sa = q16_mul(amp, div_q(TRACK_AMP_NOISE, confidence, 16));
+	int64_t rf = (int64_t) sf * sf, ra = (int64_t) sa * sa;
+	if (track_valid) {
+		q16 df = TRACK_FREQ_DRIFT, da = q16_mul(track_amp.x, TRACK_AMP_DRIFT);
+		int64_t d = track_predict(&track_freq, freq, rf, (int64_t) df * df) + track_predict(&track_amp, amp, ra, (int64_t) da * da);
+		if (d <= TRACK_GATE) {
+			track_glitches = 0;
+			track_update(&track_freq, freq, rf);
+			track_update(&track_amp, amp, ra);
+			return true;
+		}
+		if (++track_glitches < TRACK_GLITCHES)
+			return false;
+		// the motion changed, start over from this frame
+		avg_m_count = 0;
+	}
+	track_seed(&track_freq, freq, rf);
+	track_seed(&track_amp, amp, ra);
+	track_valid = true;
+	track_glitches = 0;
+	return true;
+}
+#endif
+
+static void accumulate_final(int32_t avgF, q16 freq, q16 amp) {
+#if !TRACK_FRAMES
+	// a peak that moved by more than a bin is another motion
+	if (avg_m_count > 0 && abs(avgF - lastAvgF) > 256 << LENGTH_SHIFT)
+		avg_m_count = 0;
+#endif
+	lastAvgF = avgF;
+	// outliers against the frames so far, the median needs three of them
+	if (avg_m_count >= 3 && (!final_inlier(avg_m_freqs, avg_m_count, freq, FINAL_FREQ_FLOOR)
+			|| !final_inlier(avg_m_amps, avg_m_count, amp, q16_mul(amp, FINAL_AMP_FLOOR)))) {
+		avg_m_rejected++;
+		return;
+	}
+	avg_m_freqs[avg_m_count] = freq;
+	avg_m_amps[avg_m_count] = amp;
+	avg_m_count++;
+
+	int16_t needed = FINAL_FRAMES;
+#if PHASE_ESTIMATE
+	if (phase_locked)
+		needed = FINAL_FRAMES_LOCKED;
+#endif
+	if (avg_m_count >= needed && (avg_m_count >= FINAL_WINDOW || final_within_tolerance())) {
+		// rounded means, the amplitude of small motions is only a few hundred LSB
+		Measurement m = Measurement(0, trimmed_mean(avg_m_freqs, avg_m_count), trimmed_mean(avg_m_amps, avg_m_count));
+		final_stats = (MeasureFinalStats) { avg_m_count, avg_m_rejected, avg_m_skipped };
+		APP_LOG(APP_LOG_LEVEL_DEBUG, "final: %d frames accepted, %d rejected, %d skipped",
+			avg_m_count, avg_m_rejected, avg_m_skipped);
+		avg_m_count = 0;
+		avg_m_rejected = 0;
+		avg_m_skipped = 0;
+		final_callback(m);
+	}
+}
+
+// accumulate is false for the extra in-between updates of the sliding DFT
+static void do_measure(bool accumulate) {
+	Estimate e;
+	analyzer->estimate(accumulate, &e);
+	engine_estimates[analyzer - analyzers]++;
+	q16 freq = e.freq, amp = e.amp;
+	int32_t avgF = e.f;
+	// thresholds are on the peak SNR in dB
+	q16 snr = snr_db(e.snr);
 /*	char str[16], str2[16], str3[16];
-	floatStr(str, confidence, 2);
-	floatStr(str2, amp, 2);
-	floatStr(str3, freq, 2);
-APP_LOG(APP_LOG_LEVEL_DEBUG, "C: %s, A: %s, F: %s", str, str2, str3);*/
+	fixedStr(str, snr, 2);
+	fixedStr(str2, amp, 2);
+	fixedStr(str3, freq, 2);
+APP_LOG(APP_LOG_LEVEL_DEBUG, "SNR: %s, A: %s, F: %s", str, str2, str3);*/
+	if (accumulate && hop_adaptive)
+		adapt_hop(snr, avgF);
+	if (accumulate && analyzer->adapt != NULL)
+		analyzer->adapt(snr, avgF);
+	// frames without a clear peak are left out instead of starting over
+	bool accepted = accumulate && snr >= MEASURE_SNR_CLEAR;
+	if (accumulate && !accepted)
+		avg_m_skipped++;
+#if TRACK_FRAMES
+	// the tracker weighs frames by the amplitude ratio
+	q16 confidence = int_sqrt(e.snr) << 8;
+	if (accepted && !track_frame(freq, amp, confidence)) {
+		accepted = false;
+		avg_m_rejected++;
+	}
+	// the live values follow the tracked motion once there is one
+	q16 shownFreq = track_valid ? track_freq.x : freq, shownAmp = track_valid ? track_amp.x : amp;
+	if (accumulate) {
+		weight_spread = -1;
+		if (accepted) {
+			// 1.96 deviations, anything wider than the root of the clamped variance is far from stable anyway
+			int64_t var = weight_var(track_freq.p, track_amp.p, 0);
+			weight_spread = ((int64_t) int_sqrt(var < UINT32_MAX ? var : UINT32_MAX) * 502 + (1 << 15)) >> 16;
+		}
+	}
+#else
+	q16 shownFreq = freq, shownAmp = amp;
+	if (accumulate)
+		weight_spread = accepted ? live_spread(avgF, model_weight(freq, amp)) : -1;
+#endif
 	if (callback != NULL) {
-		callback(fft_in, NUM_POINTS, offset, Measurement(confidence, freq, amp));
+		Measurement m = Measurement(snr, shownFreq, shownAmp);
+		m.weight = model_weight(shownFreq, shownAmp);
+		callback(e.window, e.offset, m);
 	}
 	
 	// if a final value is needed then accumulate
-	if (final_callback != NULL) {
-		// keep measuring while confidence > 1
-		if (confidence < 0.5) {
-//APP_LOG(APP_LOG_LEVEL_DEBUG, "reset: confidence");
-			// reset all values
-			avg_m_count = 0;
-		} else {
-			// add another value if freq and amp stayed within 10%
-			float df = abs(avgF - lastAvgF);
-			//float da = abs(amp - avg_m.amp);
-			if (avg_m_count == 0) {
-				avg_m.freq = 0;
-				avg_m.amp  = 0;
-			} else if (df > 1) {
-//APP_LOG(APP_LOG_LEVEL_DEBUG, "reset: amp/freq");
-				avg_m_count = 0;
-				avg_m.freq = 0;
-				avg_m.amp  = 0;
-				;
-			}
-			lastAvgF = avgF;
-			avg_m_count++;
-			avg_m.freq += freq;
-			avg_m.amp += amp;
-
-//			char stra[16], stra2[16], stra3[16];
-//APP_LOG(APP_LOG_LEVEL_DEBUG, "%s: C: %d, A: %s, F: %s, F: %s", str, avg_m_count, floatStr(stra, avg_m.amp, 2), floatStr(stra2, avg_m.freq / avg_m_count, 2), floatStr(stra3, freq, 2));
-
-			// if we have 3 good values then invoke the callback
-			if (avg_m_count >= 3) {
-				avg_m.freq /= avg_m_count;
-				avg_m.amp /= avg_m_count;
-				avg_m_count = 0;
-				final_callback(avg_m);
-			}
-		}
-	}
+	if (final_callback != NULL && accepted)
+		accumulate_final(avgF, freq, amp);
 }
 
 
+#if DC_BLOCK
+// high pass gain at num / den cycles per input sample in Q15
+// |H|^2 = 4s^2 / (e^2 + 4(1 - e)s^2) with s = sin(pi num / den) and e = 2^-DC_SHIFT
+static int32_t dc_block_gain(int num, int den) {
+	int64_t s = sin_lookup(TRIG_MAX_ANGLE / 2 * num / den);
+	int64_t s4 = 4 * s * s;
+	int64_t den2 = (1LL << (32 - 2 * DC_SHIFT)) + s4 - (s4 >> DC_SHIFT);
+	return int_sqrt(div_q(s4, den2, 30));
+}
+#endif
+
+// scale a raw measurement into fft range
+static kiss_fft_scalar scale_sample(int32_t len) {
+	int32_t val = (((int32_t) len * SAMP_MAX / MAX_VALUE));
+	if (val > SAMP_MAX) val = SAMP_MAX;
+	if (val < -SAMP_MAX) val = -SAMP_MAX;
+	return val;
+}
+
 static void accel_callback(AccelRawData *data, uint32_t num_samples, uint64_t timestamp) {
-	// move graph forward by number of samples
-	memcpy(fft_in, &fft_in[num_samples], (NUM_POINTS - num_samples) * sizeof(kiss_fft_scalar));
+#if MOTION_SIGNAL == MOTION_GRAVITY
+	// project onto the gravity direction at the start of the batch, it changes too slowly to matter within one
+	if (!gravity_valid) {
+		gravity[0] = data[0].x * (1 << GRAVITY_FRAC);
+		gravity[1] = data[0].y * (1 << GRAVITY_FRAC);
+		gravity[2] = data[0].z * (1 << GRAVITY_FRAC);
+		gravity_valid = true;
+	}
+	int32_t gx = gravity[0] >> GRAVITY_FRAC, gy = gravity[1] >> GRAVITY_FRAC, gz = gravity[2] >> GRAVITY_FRAC;
+	int32_t gnorm = int_sqrt(gx * gx + gy * gy + gz * gz);
+#endif
 	// add new measurements scaled into fft range
-	int j = 0;
-	for (uint i = NUM_POINTS - num_samples; i < NUM_POINTS; i++, j++) {
-		// do later: adapt to any swinging direction
-		//float len = mySqrt((int32_t) data[j].x * data[j].x + (int32_t) data[j].y * data[j].y + (int32_t) data[j].z * data[j].z);
+	for (uint j = 0; j < num_samples; j++) {
+#if MOTION_SIGNAL == MOTION_GRAVITY
+		gravity[0] += (data[j].x * (1 << GRAVITY_FRAC) - gravity[0]) >> GRAVITY_SHIFT;
+		gravity[1] += (data[j].y * (1 << GRAVITY_FRAC) - gravity[1]) >> GRAVITY_SHIFT;
+		gravity[2] += (data[j].z * (1 << GRAVITY_FRAC) - gravity[2]) >> GRAVITY_SHIFT;
 		int32_t len = data[j].z;
-		int32_t val = (((int32_t) len * SAMP_MAX / MAX_VALUE));
-		if (val > SAMP_MAX) val = SAMP_MAX;
-		if (val < -SAMP_MAX) val = -SAMP_MAX;
-		fft_in[i] = val;
+		if (gnorm > 0)
+			len = (data[j].x * gx + data[j].y * gy + data[j].z * gz) / gnorm;
+#else
+		int32_t len = data[j].z;
+#endif
+#if DC_BLOCK
+		// the transform input is zero mean and the decimator starts from zero without a transient
+		if (!dc_valid) {
+			dc_in = len;
+			dc_out = 0;
+			dc_valid = true;
+		}
+		dc_out += (len - dc_in) * (1 << DC_FRAC) - (dc_out >> DC_SHIFT);
+		dc_in = len;
+		len = (dc_out + (1 << (DC_FRAC - 1))) >> DC_FRAC;
+#endif
+		kiss_fft_scalar val = scale_sample(len);
+#if DECIMATION > 1
+		// only every DECIMATION-th filtered sample reaches the spectrum
+		if (!cic_push(cic, val, &val))
+			continue;
+#endif
+		samples[sample_pos++ & SAMPLE_MASK] = val;
+		if (analyzer->push != NULL)
+			analyzer->push(val);
 	}
-	if (next_draw++ >= 4) {
-		next_draw = 0;
-		do_measure();
+	// analyse once per hop
+	bool accumulate = false;
+	hop_samples += num_samples;
+	if (hop_samples >= hop) {
+		hop_samples = 0;
+		accumulate = true;
 	}
+	// the sliding spectrum is current after every batch
+	if (accumulate || analyzer->every_batch)
+		do_measure(accumulate);
 }
 
 bool is_measuring() {
 	return measure_running;
 }
 
-void start_measure(MeasureHandler measureHandler, FinalMeasureHandler finalHandler) {
+void start_measure(MeasureEngine engine, MeasureHandler measureHandler, FinalMeasureHandler finalHandler) {
 	callback = measureHandler;
 	final_callback = finalHandler;
 	avg_m_count = 0;
+	avg_m_rejected = 0;
+	avg_m_skipped = 0;
+	// a running measurement only starts over for another engine
+	if (measure_running && analyzer == &analyzers[engine])
+		return;
+	analyzer = &analyzers[engine];
+	hop_samples = 0;
+	hop_quiet_frames = 0;
+	sample_start = sample_pos;
+	hop_last_snr = 0;
+	if (hop_adaptive)
+		set_hop(HOP_DEFAULT);
+	if (analyzer->reset != NULL)
+		analyzer->reset();
+#if TRACK_FRAMES
+	track_valid = false;
+#else
+	live_count = 0;
+#endif
+	weight_spread = -1;
 	if (measure_running)
 		return;
 	measure_running = true;
-  accel_raw_data_service_subscribe(25, (AccelRawDataHandler) accel_callback);
-  accel_service_set_sampling_rate(SAMPLE_RATE);
+#if MOTION_SIGNAL == MOTION_GRAVITY
+	// the wrist may be held differently than last time
+	gravity_valid = false;
+#endif
+#if DC_BLOCK
+	dc_valid = false;
+#endif
+#if DECIMATION > 1
+	cic_reset(cic);
+#endif
+  accel_raw_data_service_subscribe(batch, (AccelRawDataHandler) accel_callback);
+  accel_service_set_sampling_rate((AccelSamplingRate) SAMPLE_RATE);
+}
+void measure_set_schedule(uint16_t hop_samples, uint16_t batch_samples) {
+	batch = batch_samples < 1 ? 1 : (batch_samples > BATCH_MAX ? BATCH_MAX : batch_samples);
+	hop_adaptive = hop_samples == 0;
+	set_hop(hop_adaptive ? HOP_DEFAULT : hop_samples);
+	if (measure_running)
+		accel_service_set_samples_per_update(batch);
 }
+
+MeasureEngineStats measure_engine_stats(MeasureEngine engine) {
+	return (MeasureEngineStats) {
+		engine_estimates[engine], benchmark_us(&analyzers[engine]), analyzers[engine].memory()
+	};
+}
+
+MeasureFinalStats measure_final_stats() {
+	return final_stats;
+}
+
+void measure_set_model(int32_t grams, q16 amp_gain, q16 freq_gain, q16 offset) {
+	tolerance = grams;
+	model_amp_gain = amp_gain;
+	model_freq_gain = freq_gain;
+	model_offset = offset;
+}
+
+int32_t measure_weight_spread() {
+	return weight_spread;
+}
+
 void stop_measure() {
 	callback = NULL;
 	if (!measure_running)
@@ -161,10 +1399,41 @@ void stop_measure() {
 void init_measure() {
 	// init FFT stuff
 	memset(&fft_zero, 0, sizeof(fft_zero));
-	fft_cfg = kiss_fftr_alloc(NUM_POINTS, 0, 0, 0);
+	for (int i = 0; i < MEASURE_ENGINE_COUNT; i++)
+		analyzers[i].init();
+#if DECIMATION > 1
+	cic = cic_alloc(DECIMATION, CIC_ORDER);
+#endif
+#if BAND_GAIN
+	// bins below MIN_BIN are not analysed, unity there keeps the correction from dividing by zero
+	for (int k = 0; k < MIN_BIN; k++)
+		band_gain[k] = 32768;
+	for (int k = MIN_BIN; k < NUM_BINS; k++) {
+		int32_t gain = 32768;
+#if DECIMATION > 1
+		gain = cic_gain(cic, k, MAX_POINTS * DECIMATION);
+#endif
+#if DC_BLOCK
+		gain = (gain * dc_block_gain(k, MAX_POINTS * DECIMATION)) >> 15;
+#endif
+		band_gain[k] = gain;
+	}
+#endif
+	// DSP working memory
+	int total = sizeof(samples);
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "dsp memory: samples %d bytes", (int) sizeof(samples));
+	for (int i = 0; i < MEASURE_ENGINE_COUNT; i++) {
+		APP_LOG(APP_LOG_LEVEL_DEBUG, "dsp memory: %s engine %d bytes", analyzers[i].name, analyzers[i].memory());
+		total += analyzers[i].memory();
+	}
+	APP_LOG(APP_LOG_LEVEL_DEBUG, "dsp memory: total %d bytes", total);
 }
 void clean_measure() {
 	stop_measure();
-	free(fft_cfg);
+	for (int i = 0; i < MEASURE_ENGINE_COUNT; i++)
+		analyzers[i].deinit();
+#if DECIMATION > 1
+	cic_free(cic);
+#endif
 	kiss_fft_cleanup();
 }
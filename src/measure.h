@@ -1,24 +1,89 @@
 #pragma once
 #include "_kiss_fft_guts.h"
 #include "kiss_fftr.h"
+#include "utils.h"
 
+// weight in grams, the rest in Q16: freq in Hz, amp in g, confidence as the peak SNR in dB
 #pragma pack(push, 4)
 typedef struct {
-  float weight;
-  float freq;
-  float amp;
-	float confidence;
+  int32_t weight;
+  q16 freq;
+  q16 amp;
+	q16 confidence;
 } Measurement;
 #pragma pack(pop)
 #define Measurement(c, f, a) ((Measurement){(0), (f), (a), (c)})
 
-typedef void (*MeasureHandler)(kiss_fft_scalar *data, uint32_t num_samples, kiss_fft_scalar offset, Measurement measurement);
+// sample history is a ring buffer, must be a power of two
+#define SAMPLE_BUFFER_SIZE 256
+
+// window of count samples in the sample ring, starting at the oldest one
+// stays valid until SAMPLE_BUFFER_SIZE - count newer samples have been written
+typedef struct {
+	const kiss_fft_scalar *buffer;
+	uint32_t start;
+	uint32_t count;
+} SampleView;
+#define sample_view_get(view, i) ((view).buffer[((view).start + (i)) & (SAMPLE_BUFFER_SIZE - 1)])
+
+typedef void (*MeasureHandler)(SampleView samples, kiss_fft_scalar offset, Measurement measurement);
 typedef void (*FinalMeasureHandler)(Measurement measurement);
 
+// peak SNR in dB above which a motion stands out of the noise, and above which
+// a frame is clear enough to count towards the final value
+#define MEASURE_SNR_VISIBLE Q16(16)
+#define MEASURE_SNR_CLEAR Q16(20)
+
+// analysis engines, each reports the dominant period of the motion
+typedef enum {
+	MEASURE_ENGINE_SPECTRUM,			// peak of the spectrum, FFT unless built with another SPECTRUM_ENGINE
+	MEASURE_ENGINE_YIN,						// time domain autocorrelation (YIN difference function)
+	MEASURE_ENGINE_ZERO_CROSSING,	// mean period between rising zero crossings
+	MEASURE_ENGINE_COUNT
+} MeasureEngine;
+// calibrations only hold for the engine they were taken with
+#define MEASURE_ENGINE_DEFAULT MEASURE_ENGINE_SPECTRUM
+
+// estimates of an engine since init_measure and what one costs. The CPU cycle counter is not
+// readable from apps and the clock only has milliseconds, so measure_engine_stats times estimates
+// back to back over the current sample ring for about 50 ms and divides, the spectrum at the
+// window length in use. That blocks the app, so only engine comparisons and debugging call it,
+// best after stop_measure while the ring still holds the last motion. memory is its working
+// memory besides the sample ring.
+typedef struct {
+	uint32_t estimates;
+	uint32_t us_per_estimate;
+	uint32_t memory;
+} MeasureEngineStats;
+
+// frames behind the last final value: accepted into its trimmed mean, rejected as outliers
+// or glitches of the tracked motion, and skipped without a clear peak
+typedef struct {
+	uint16_t accepted;
+	uint16_t rejected;
+	uint16_t skipped;
+} MeasureFinalStats;
+
 bool is_measuring();
 
 void init_measure();
 void clean_measure();
 
-void start_measure(MeasureHandler measureHandler, FinalMeasureHandler finalHandler);
+void start_measure(MeasureEngine engine, MeasureHandler measureHandler, FinalMeasureHandler finalHandler);
+// analysis every hop accelerometer samples delivered in batches of batch (at most 25),
+// hop 0 adapts it to the signal: faster while confidence rises, slower without motion or once stable
+void measure_set_schedule(uint16_t hop, uint16_t batch);
+// weight = amp_gain * amp + freq_gain * freq + offset, gains in Q16 grams per g and per Hz and the
+// offset in Q16 grams. Live measurements carry the weight of the tracked motion, the final value
+// is reported once the 95% confidence interval of its weight is within +-grams.
+#define MEASURE_TOLERANCE_DEFAULT 20
+void measure_set_model(int32_t grams, q16 amp_gain, q16 freq_gain, q16 offset);
+// measuring goes on after a final value until stop_measure, the next one starts from the frames
+// after it while the tracked motion carries over, so weighing can continue without starting over
 void stop_measure();
+// half width of the 95% confidence interval of the live weight in grams, -1 while the last frame
+// had no clear motion, stable once it is within the tolerance. Without the tracker it is the
+// interval of the mean of the latest frames, which needs two of them.
+int32_t measure_weight_spread();
+MeasureEngineStats measure_engine_stats(MeasureEngine engine);
+MeasureFinalStats measure_final_stats();
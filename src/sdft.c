@@ -0,0 +1,79 @@
+#include <pebble.h>
+#include "_kiss_fft_guts.h"
+#include "sdft.h"
+
+// products are shifted down before accumulating so nfft of them fit into int32
+#define SDFT_SHIFT 9
+#define SDFT_MAX_NFFT 1024
+
+struct sdft_state {
+	int nfft;
+	int num_bins;
+	int pos;						// absolute position of the next sample, mod nfft
+	int16_t *cos_table;	// cos(2*pi*i/nfft) in Q15
+	int16_t *sin_table;	// sin(2*pi*i/nfft) in Q15, its own table so nfft need not be a multiple of 4
+	int32_t *acc;				// re, im per bin
+};
+
+sdft_cfg sdft_alloc(int nfft, int num_bins) {
+	if (nfft < 1 || nfft > SDFT_MAX_NFFT || num_bins > nfft / 2 + 1)
+		return NULL;
+	size_t memneeded = sizeof(struct sdft_state) + sizeof(int32_t) * 2 * num_bins + sizeof(int16_t) * 2 * nfft;
+	sdft_cfg st = (sdft_cfg) malloc(memneeded);
+	if (st == NULL)
+		return NULL;
+	st->nfft = nfft;
+	st->num_bins = num_bins;
+	st->acc = (int32_t *) (st + 1);
+	st->cos_table = (int16_t *) (st->acc + 2 * num_bins);
+	st->sin_table = st->cos_table + nfft;
+	sdft_reset(st);
+	for (int i = 0; i < nfft; i++) {
+		st->cos_table[i] = cos_lookup(TRIG_MAX_ANGLE * i / nfft) * SAMP_MAX / TRIG_MAX_RATIO;
+		st->sin_table[i] = sin_lookup(TRIG_MAX_ANGLE * i / nfft) * SAMP_MAX / TRIG_MAX_RATIO;
+	}
+	return st;
+}
+
+void sdft_reset(sdft_cfg st) {
+	st->pos = 0;
+	memset(st->acc, 0, sizeof(int32_t) * 2 * st->num_bins);
+}
+
+void sdft_push(sdft_cfg st, kiss_fft_scalar in, kiss_fft_scalar out) {
+	const int nfft = st->nfft;
+	int32_t *acc = st->acc;
+	// DC needs no twiddle
+	acc[0] += in - out;
+	// index of bin k is k * pos mod nfft
+	int idx = 0;
+	for (int k = 1; k < st->num_bins; k++) {
+		idx += st->pos;
+		if (idx >= nfft) idx -= nfft;
+		int32_t c = st->cos_table[idx], s = st->sin_table[idx];
+		// shift each product separately so removing a sample cancels its addition exactly
+		acc[2 * k] += ((in * c) >> SDFT_SHIFT) - ((out * c) >> SDFT_SHIFT);
+		acc[2 * k + 1] -= ((in * s) >> SDFT_SHIFT) - ((out * s) >> SDFT_SHIFT);
+	}
+	if (++st->pos >= nfft)
+		st->pos = 0;
+}
+
+void sdft_spectrum(sdft_cfg st, kiss_fft_cpx *freqdata) {
+	const int nfft = st->nfft;
+	const int32_t div = nfft << (FRACBITS - SDFT_SHIFT);
+	int32_t *acc = st->acc;
+	freqdata[0].r = acc[0] / nfft;
+	freqdata[0].i = 0;
+	// rotate accumulators so the oldest sample in the window has phase 0
+	int idx = 0;
+	for (int k = 1; k < st->num_bins; k++) {
+		idx += st->pos;
+		if (idx >= nfft) idx -= nfft;
+		int32_t c = st->cos_table[idx], s = st->sin_table[idx];
+		int32_t re = (int32_t) (((int64_t) acc[2 * k] * c - (int64_t) acc[2 * k + 1] * s) >> FRACBITS);
+		int32_t im = (int32_t) (((int64_t) acc[2 * k] * s + (int64_t) acc[2 * k + 1] * c) >> FRACBITS);
+		freqdata[k].r = re / div;
+		freqdata[k].i = im / div;
+	}
+}
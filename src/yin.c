@@ -0,0 +1,74 @@
+#include <pebble.h>
+#include "_kiss_fft_guts.h"
+#include "yin.h"
+
+struct yin_state {
+	int window;
+	int min_lag;
+	int max_lag;
+	int32_t threshold;
+	uint32_t *cmndf;		// d'(tau) in Q16 for tau 0..max_lag
+};
+
+yin_cfg yin_alloc(int window, int min_lag, int max_lag, int32_t threshold) {
+	if (window < 1 || min_lag < 1 || max_lag <= min_lag)
+		return NULL;
+	yin_cfg st = (yin_cfg) malloc(sizeof(struct yin_state) + sizeof(uint32_t) * (max_lag + 1));
+	if (st == NULL)
+		return NULL;
+	st->window = window;
+	st->min_lag = min_lag;
+	st->max_lag = max_lag;
+	st->threshold = threshold;
+	st->cmndf = (uint32_t *) (st + 1);
+	return st;
+}
+
+int yin_memory(yin_cfg st) {
+	return sizeof(struct yin_state) + sizeof(uint32_t) * (st->max_lag + 1);
+}
+
+int32_t yin_period(yin_cfg st, const kiss_fft_scalar *buffer, uint32_t mask, uint32_t start, int32_t *aperiodicity) {
+	const int window = st->window, max_lag = st->max_lag;
+	uint32_t *cmndf = st->cmndf;
+	// a squared difference of two samples fits 32 bits, a window of them 64
+	uint64_t running = 0;
+	cmndf[0] = 1 << 16;
+	for (int tau = 1; tau <= max_lag; tau++) {
+		uint64_t d = 0;
+		for (int j = 0; j < window; j++) {
+			// differences reach twice the sample range, square them unsigned
+			uint32_t diff = abs(buffer[(start + j) & mask] - buffer[(start + j + tau) & mask]);
+			d += diff * diff;
+		}
+		running += d;
+		cmndf[tau] = running > 0 ? (uint32_t) (((d * tau) << 16) / running) : 1 << 16;
+	}
+
+	// first dip below the threshold, followed down to its minimum, or the deepest one
+	int best = st->min_lag;
+	for (int tau = st->min_lag; tau <= max_lag; tau++) {
+		if (cmndf[tau] < (uint32_t) st->threshold) {
+			while (tau < max_lag && cmndf[tau + 1] < cmndf[tau])
+				tau++;
+			best = tau;
+			break;
+		}
+		if (cmndf[tau] < cmndf[best])
+			best = tau;
+	}
+	*aperiodicity = cmndf[best];
+
+	int32_t period = best << 8;
+	if (best > st->min_lag && best < max_lag) {
+		int32_t l = cmndf[best - 1], c = cmndf[best], r = cmndf[best + 1];
+		int32_t den = 2 * (l - 2 * c + r);
+		if (den > 0) {
+			int32_t d = (int32_t) ((int64_t) (l - r) * 256 / den);
+			if (d > 128) d = 128;
+			if (d < -128) d = -128;
+			period += d;
+		}
+	}
+	return period;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "kiss_fft.h"
+
+/*
+	YIN period estimator over a window of a power of two ring buffer.
+
+	The difference function d(tau) = sum (x[j] - x[j+tau])^2 over window samples is normalized
+	by its running mean, d'(tau) = d(tau) * tau / sum d(1..tau), which starts at 1 and dips
+	towards 0 at every multiple of the period. The first dip below the threshold is the period,
+	which avoids locking onto multiples, and a parabola through its neighbours refines it.
+	The difference does not depend on the offset of the samples, the mean need not be removed.
+*/
+
+typedef struct yin_state *yin_cfg;
+
+// lags min_lag..max_lag with 1 <= min_lag < max_lag, threshold on d' in Q16, returns NULL otherwise
+yin_cfg yin_alloc(int window, int min_lag, int max_lag, int32_t threshold);
+
+// analyses window + max_lag samples starting at buffer[start & mask], returns the period in
+// 1/256 samples and writes d' at it to *aperiodicity in Q16, 0 near the ideal of a clean period
+int32_t yin_period(yin_cfg st, const kiss_fft_scalar *buffer, uint32_t mask, uint32_t start, int32_t *aperiodicity);
+
+// bytes allocated for st
+int yin_memory(yin_cfg st);
+
+#define yin_free free
@@ -0,0 +1,87 @@
+#include <pebble.h>
+#include "_kiss_fft_guts.h"
+#include "zero_cross.h"
+#include "utils.h"
+
+// crossing times kept, a power of two
+#define MAX_CROSSINGS 16
+// decay of the peak per sample, 1/2^ENVELOPE_SHIFT of it
+#define ENVELOPE_SHIFT 5
+
+struct zero_cross_state {
+	int dc_shift;
+	bool dc_valid;
+	int32_t dc;					// low passed input with 8 fraction bits
+	int32_t envelope;		// decaying peak of the signal without offset
+	int32_t last;				// previous sample without offset
+	bool armed;					// went below -envelope / 4 since the last crossing
+	uint32_t pos;				// samples pushed
+	uint32_t count;			// crossings found, the last MAX_CROSSINGS are kept
+	uint32_t times[MAX_CROSSINGS];	// in 1/256 samples, wrapping
+};
+
+zero_cross_cfg zero_cross_alloc(int dc_shift) {
+	zero_cross_cfg st = (zero_cross_cfg) malloc(sizeof(struct zero_cross_state));
+	if (st == NULL)
+		return NULL;
+	st->dc_shift = dc_shift;
+	zero_cross_reset(st);
+	return st;
+}
+
+void zero_cross_reset(zero_cross_cfg st) {
+	st->dc_valid = false;
+	st->envelope = 0;
+	st->last = 0;
+	st->armed = false;
+	st->pos = 0;
+	st->count = 0;
+}
+
+int zero_cross_memory(zero_cross_cfg st) {
+	return sizeof(struct zero_cross_state);
+}
+
+void zero_cross_push(zero_cross_cfg st, kiss_fft_scalar in) {
+	if (!st->dc_valid) {
+		st->dc = in * 256;
+		st->dc_valid = true;
+	}
+	st->dc += (in * 256 - st->dc) >> st->dc_shift;
+	int32_t x = in - (st->dc >> 8);
+	int32_t mag = x < 0 ? -x : x;
+	st->envelope -= st->envelope >> ENVELOPE_SHIFT;
+	if (mag > st->envelope)
+		st->envelope = mag;
+	if (x < -(st->envelope >> 2))
+		st->armed = true;
+	if (st->armed && st->last < 0 && x >= 0) {
+		// between the previous sample at pos - 1 and this one
+		st->times[st->count++ & (MAX_CROSSINGS - 1)] = ((st->pos - 1) << 8) + (-st->last << 8) / (x - st->last);
+		st->armed = false;
+	}
+	st->last = x;
+	st->pos++;
+}
+
+int32_t zero_cross_period(zero_cross_cfg st, int window, int32_t *jitter) {
+	// crossings within the window, newest first
+	uint32_t now = st->pos << 8;
+	int n = 0;
+	uint32_t available = st->count < MAX_CROSSINGS ? st->count : MAX_CROSSINGS;
+	while ((uint32_t) n < available && now - st->times[(st->count - 1 - n) & (MAX_CROSSINGS - 1)] <= (uint32_t) window << 8)
+		n++;
+	*jitter = 1 << 16;
+	if (n < 3)
+		return 0;
+	uint32_t first = st->times[(st->count - n) & (MAX_CROSSINGS - 1)], last = st->times[(st->count - 1) & (MAX_CROSSINGS - 1)];
+	int32_t period = (int32_t) (last - first) / (n - 1);
+	// spread of the single periods around the mean
+	uint64_t var = 0;
+	for (int i = 1; i < n; i++) {
+		int32_t d = (int32_t) (st->times[(st->count - n + i) & (MAX_CROSSINGS - 1)] - st->times[(st->count - n + i - 1) & (MAX_CROSSINGS - 1)]) - period;
+		var += (int64_t) d * d;
+	}
+	*jitter = div_q(int_sqrt(var / (n - 1)), period, 16);
+	return period;
+}
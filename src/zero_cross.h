@@ -0,0 +1,29 @@
+#pragma once
+#include "kiss_fft.h"
+
+/*
+	Zero crossing period tracker, updated per sample.
+
+	The offset is followed by a one pole low pass with a time constant of 2^dc_shift samples
+	and a rising crossing of the remaining signal counts once it went below a quarter of
+	its decaying peak since the last one, so noise around zero does not add crossings.
+	Crossing times are interpolated between the two samples around them.
+*/
+
+typedef struct zero_cross_state *zero_cross_cfg;
+
+zero_cross_cfg zero_cross_alloc(int dc_shift);
+
+// start over without crossings, the offset is seeded from the next sample
+void zero_cross_reset(zero_cross_cfg st);
+
+void zero_cross_push(zero_cross_cfg st, kiss_fft_scalar in);
+
+// mean period of the crossings within the last window samples in 1/256 samples, 0 with less
+// than three, and the deviation of single periods from it relative to it in Q16 to *jitter
+int32_t zero_cross_period(zero_cross_cfg st, int window, int32_t *jitter);
+
+// bytes allocated for st
+int zero_cross_memory(zero_cross_cfg st);
+
+#define zero_cross_free free
@@ -0,0 +1,231 @@
+#!/usr/bin/env python
+"""
+Generates src/kiss_fft_codelets.h, forward butterfly codelets for the complex
+FFT behind each real FFT size, used by kiss_fft.c when KISS_FFT_CODELETS is
+defined. They replace the butterflies of each stage in kf_work_iterative.
+Every stage becomes its own function with m, strides and the radix constants
+fixed, so there is no twiddle stride indexing left at runtime.
+
+The codelets do the same fixed point operations in the same order as
+kf_bfly2..5 with the same twiddle values as tools/gen_fft_plan.py, so output is
+bit exact with the generic butterflies on a static plan.
+
+level 0: no codelets, kiss_fft uses the generic butterflies
+level 1: one loop per stage reading twiddles from a packed per stage table (smaller)
+level 2: every butterfly of a stage unrolled with its twiddles as constants (faster)
+
+usage: gen_fft_codelets.py [--level N] [nfft ...]   (default: --level 1 50 100 200)
+"""
+import math
+import os
+import sys
+
+from gen_fft_plan import DEFAULT_SIZES, factor, fixed, schedule
+
+DEFAULT_LEVEL = 1
+RADIXES = (2, 3, 4, 5)
+
+
+def twiddle(n, i):
+    phase = -2 * math.pi * i / n
+    return fixed(math.cos(phase)), fixed(math.sin(phase))
+
+
+def const(w):
+    return '((kiss_fft_cpx){ %d, %d })' % w
+
+
+class Stage:
+    def __init__(self, n, p, m, fstride):
+        self.n, self.p, self.m, self.fstride = n, p, m, fstride
+        self.blocks = n // (p * m)
+
+    def twiddles(self, u):
+        # twiddles of butterfly u for outputs 1..p-1, as kf_bfly* index them
+        return [twiddle(self.n, q * u * self.fstride) for q in range(1, self.p)]
+
+
+def bfly2(F, w, _):
+    return [
+        'C_FIXDIV(%s,2); C_FIXDIV(%s,2);' % (F[0], F[1]),
+        'C_MUL(t,%s,%s);' % (F[1], w[0]),
+        'C_SUB(%s,%s,t);' % (F[1], F[0]),
+        'C_ADDTO(%s,t);' % F[0],
+    ]
+
+
+def bfly3(F, w, st):
+    epi3 = twiddle(st.n, st.fstride * st.m)
+    return [
+        'C_FIXDIV(%s,3); C_FIXDIV(%s,3); C_FIXDIV(%s,3);' % tuple(F),
+        'C_MUL(scratch[1],%s,%s);' % (F[1], w[0]),
+        'C_MUL(scratch[2],%s,%s);' % (F[2], w[1]),
+        'C_ADD(scratch[3],scratch[1],scratch[2]);',
+        'C_SUB(scratch[0],scratch[1],scratch[2]);',
+        '%s.r = %s.r - HALF_OF(scratch[3].r);' % (F[1], F[0]),
+        '%s.i = %s.i - HALF_OF(scratch[3].i);' % (F[1], F[0]),
+        'C_MULBYSCALAR(scratch[0],%d);' % epi3[1],
+        'C_ADDTO(%s,scratch[3]);' % F[0],
+        '%s.r = %s.r + scratch[0].i;' % (F[2], F[1]),
+        '%s.i = %s.i - scratch[0].r;' % (F[2], F[1]),
+        '%s.r -= scratch[0].i;' % F[1],
+        '%s.i += scratch[0].r;' % F[1],
+    ]
+
+
+def bfly4(F, w, _):
+    return [
+        'C_FIXDIV(%s,4); C_FIXDIV(%s,4); C_FIXDIV(%s,4); C_FIXDIV(%s,4);' % tuple(F),
+        'C_MUL(scratch[0],%s,%s);' % (F[1], w[0]),
+        'C_MUL(scratch[1],%s,%s);' % (F[2], w[1]),
+        'C_MUL(scratch[2],%s,%s);' % (F[3], w[2]),
+        'C_SUB(scratch[5],%s,scratch[1]);' % F[0],
+        'C_ADDTO(%s,scratch[1]);' % F[0],
+        'C_ADD(scratch[3],scratch[0],scratch[2]);',
+        'C_SUB(scratch[4],scratch[0],scratch[2]);',
+        'C_SUB(%s,%s,scratch[3]);' % (F[2], F[0]),
+        'C_ADDTO(%s,scratch[3]);' % F[0],
+        '%s.r = scratch[5].r + scratch[4].i;' % F[1],
+        '%s.i = scratch[5].i - scratch[4].r;' % F[1],
+        '%s.r = scratch[5].r - scratch[4].i;' % F[3],
+        '%s.i = scratch[5].i + scratch[4].r;' % F[3],
+    ]
+
+
+def bfly5(F, w, st):
+    ya = twiddle(st.n, st.fstride * st.m)
+    yb = twiddle(st.n, st.fstride * 2 * st.m)
+    s = {'yar': ya[0], 'yai': ya[1], 'ybr': yb[0], 'ybi': yb[1]}
+    return [
+        'C_FIXDIV(%s,5); C_FIXDIV(%s,5); C_FIXDIV(%s,5); C_FIXDIV(%s,5); C_FIXDIV(%s,5);' % tuple(F),
+        'scratch[0] = %s;' % F[0],
+        'C_MUL(scratch[1],%s,%s);' % (F[1], w[0]),
+        'C_MUL(scratch[2],%s,%s);' % (F[2], w[1]),
+        'C_MUL(scratch[3],%s,%s);' % (F[3], w[2]),
+        'C_MUL(scratch[4],%s,%s);' % (F[4], w[3]),
+        'C_ADD(scratch[7],scratch[1],scratch[4]);',
+        'C_SUB(scratch[10],scratch[1],scratch[4]);',
+        'C_ADD(scratch[8],scratch[2],scratch[3]);',
+        'C_SUB(scratch[9],scratch[2],scratch[3]);',
+        '%s.r += scratch[7].r + scratch[8].r;' % F[0],
+        '%s.i += scratch[7].i + scratch[8].i;' % F[0],
+        'scratch[5].r = scratch[0].r + S_MUL(scratch[7].r,%(yar)d) + S_MUL(scratch[8].r,%(ybr)d);' % s,
+        'scratch[5].i = scratch[0].i + S_MUL(scratch[7].i,%(yar)d) + S_MUL(scratch[8].i,%(ybr)d);' % s,
+        'scratch[6].r = S_MUL(scratch[10].i,%(yai)d) + S_MUL(scratch[9].i,%(ybi)d);' % s,
+        'scratch[6].i = -S_MUL(scratch[10].r,%(yai)d) - S_MUL(scratch[9].r,%(ybi)d);' % s,
+        'C_SUB(%s,scratch[5],scratch[6]);' % F[1],
+        'C_ADD(%s,scratch[5],scratch[6]);' % F[4],
+        'scratch[11].r = scratch[0].r + S_MUL(scratch[7].r,%(ybr)d) + S_MUL(scratch[8].r,%(yar)d);' % s,
+        'scratch[11].i = scratch[0].i + S_MUL(scratch[7].i,%(ybr)d) + S_MUL(scratch[8].i,%(yar)d);' % s,
+        'scratch[12].r = -S_MUL(scratch[10].i,%(ybi)d) + S_MUL(scratch[9].i,%(yai)d);' % s,
+        'scratch[12].i = S_MUL(scratch[10].r,%(ybi)d) - S_MUL(scratch[9].r,%(yai)d);' % s,
+        'C_ADD(%s,scratch[11],scratch[12]);' % F[2],
+        'C_SUB(%s,scratch[11],scratch[12]);' % F[3],
+    ]
+
+
+BFLY = {2: bfly2, 3: bfly3, 4: bfly4, 5: bfly5}
+
+
+def indent(lines, depth):
+    return ['    ' * depth + l for l in lines]
+
+
+def stage_function(name, st, level):
+    p, m = st.p, st.m
+    out = ['/* radix %d, m = %d, %d blocks */' % (p, m, st.blocks),
+           'static void %s(kiss_fft_cpx * Fout)' % name, '{']
+    decls = ['kiss_fft_cpx scratch[13];' if p != 2 else 'kiss_fft_cpx t;']
+    body = []
+    if level == 1 and m > 1:
+        # packed table: p-1 twiddles per butterfly, in butterfly order
+        table = '%s_tw' % name
+        values = [w for u in range(m) for w in st.twiddles(u)]
+        out[0:0] = ['static const kiss_fft_cpx %s[%d] = {' % (table, len(values))]
+        out[1:1] = ['    ' + ', '.join('{ %d, %d }' % w for w in values[i:i + 4]) + ','
+                    for i in range(0, len(values), 4)] + ['};']
+        decls += ['const kiss_fft_cpx * tw;', 'kiss_fft_cpx * F;', 'int u;']
+        F = ['F[%d]' % (q * m) for q in range(p)]
+        w = ['tw[%d]' % q for q in range(p - 1)]
+        inner = ['for (u=0, F=Fout, tw=%s; u<%d; ++u, ++F, tw+=%d) {' % (table, m, p - 1)]
+        inner += indent(BFLY[p](F, w, st), 1) + ['}']
+    else:
+        inner = []
+        for u in range(m):
+            F = ['Fout[%d]' % (u + q * m) for q in range(p)]
+            inner += BFLY[p](F, [const(w) for w in st.twiddles(u)], st)
+    if st.blocks > 1:
+        decls.append('int b;')
+        body = ['for (b=0; b<%d; ++b, Fout+=%d) {' % (st.blocks, p * m)] + indent(inner, 1) + ['}']
+    else:
+        body = inner
+    out += indent(decls, 1) + [''] + indent(body, 1) + ['}']
+    return '\n'.join(out)
+
+
+def codelet(nfft, level):
+    n = nfft // 2
+    factors = factor(n)
+    stages = [Stage(n, p, m, fstride) for p, m, fstride in schedule(factors)]
+    if any(st.p not in RADIXES for st in stages):
+        sys.stderr.write('no codelet for nfft %d, factors %s need the generic butterfly\n' % (nfft, factors[::2]))
+        return None
+    out = []
+    names = []
+    for i, st in enumerate(stages):
+        names.append('kf_codelet_%d_s%d' % (n, i))
+        out += [stage_function(names[-1], st, level), '']
+    out += ['static const kf_codelet kf_codelets_%d[%d] = { %s };' % (n, len(names), ', '.join(names))]
+    return n, '\n'.join(out)
+
+
+def generate(sizes, level):
+    out = [
+        '// generated by tools/gen_fft_codelets.py --level %d %s, do not edit'
+        % (level, ' '.join(str(n) for n in sizes)),
+        '// forward butterfly codelets for kf_work_iterative, included by kiss_fft.c only',
+        '',
+        '/* the butterflies of one stage, in place on the permuted buffer */',
+        'typedef void (*kf_codelet)(kiss_fft_cpx * Fout);',
+        '',
+    ]
+    cases = []
+    if level > 0:
+        for nfft in sizes:
+            c = codelet(nfft, level)
+            if c:
+                cases.append(c[0])
+                out += [c[1], '']
+    out += ['/* stage codelets for st in schedule order, NULL to use the generic butterflies */',
+            'static const kf_codelet * kf_codelet_stages(const kiss_fft_cfg st)',
+            '{']
+    if cases:
+        out += ['    if (st->inverse)',
+                '        return NULL;',
+                '    switch (st->nfft) {']
+        out += ['        case %d: return kf_codelets_%d;' % (n, n) for n in cases]
+        out += ['    }']
+    else:
+        out += ['    (void) st;']
+    out += ['    return NULL;', '}']
+    return '\n'.join(out) + '\n'
+
+
+def main(args):
+    level = DEFAULT_LEVEL
+    if args[:1] == ['--level']:
+        level = int(args[1])
+        args = args[2:]
+    if level not in (0, 1, 2):
+        sys.exit('level must be 0, 1 or 2: %d' % level)
+    sizes = [int(a) for a in args] or DEFAULT_SIZES
+    for n in sizes:
+        if n & 1:
+            sys.exit('nfft must be even: %d' % n)
+    path = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src', 'kiss_fft_codelets.h')
+    with open(path, 'w') as f:
+        f.write(generate(sizes, level))
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])
@@ -0,0 +1,165 @@
+#!/usr/bin/env python
+"""
+Generates src/kiss_fft_plan.h, the static plans used by kiss_fftr_alloc when
+KISS_FFT_STATIC_PLAN is defined: factors, twiddles, super twiddles and the
+KISS_FFT_ITERATIVE stage schedule and swap table for each real FFT size, so no trig or heap
+allocation is needed at startup. src/kiss_fft_plan_sizes.h lists the sizes so measure.c
+can check at compile time that every window length has a plan.
+
+usage: gen_fft_plan.py [nfft ...]   (default: 50 100 200)
+"""
+import math
+import os
+import sys
+
+SAMP_MAX = 32767
+DEFAULT_SIZES = [50, 100, 200]
+
+
+def factor(n):
+    # same order as kf_factor in kiss_fft.c
+    facbuf = []
+    p = 4
+    floor_sqrt = math.floor(math.sqrt(n))
+    while True:
+        while n % p:
+            if p == 4:
+                p = 2
+            elif p == 2:
+                p = 3
+            else:
+                p += 2
+            if p > floor_sqrt:
+                p = n
+        n //= p
+        facbuf += [p, n]
+        if n <= 1:
+            return facbuf
+
+
+def perm(facbuf, n_in=0, fstride=1, out=None):
+    # input index copied to each output position, same as kf_perm in kiss_fft.c
+    if out is None:
+        out = []
+    p, m = facbuf[0], facbuf[1]
+    for k in range(p):
+        if m == 1:
+            out.append(n_in + k * fstride)
+        else:
+            perm(facbuf[2:], n_in + k * fstride, fstride * p, out)
+    return out
+
+
+def swaps(facbuf):
+    # swap partner per position that applies perm in place, same as kf_swaps in kiss_fft.c
+    order = perm(facbuf)
+    at = list(range(len(order)))    # input index currently at each position
+    pos = list(range(len(order)))   # current position of each input index
+    out = []
+    for i, x in enumerate(order):
+        src = pos[x]
+        out.append(src)
+        at[src], at[i] = at[i], x
+        pos[at[src]], pos[x] = src, i
+    return out
+
+
+def schedule(facbuf):
+    # (p, m, fstride) per stage, innermost factor first, same as kf_schedule in kiss_fft.c
+    stages = []
+    fstride = 1
+    for i in range(0, len(facbuf), 2):
+        stages.append((facbuf[i], facbuf[i + 1], fstride))
+        fstride *= facbuf[i]
+    return stages[::-1]
+
+
+def int_table(ctype, name, values):
+    lines = ['static const %s %s[%d] = {' % (ctype, name, len(values))]
+    for i in range(0, len(values), 16):
+        lines.append('\t' + ', '.join(str(v) for v in values[i:i + 16]) + ',')
+    lines.append('};')
+    return '\n'.join(lines)
+
+
+def fixed(x):
+    return int(math.floor(.5 + SAMP_MAX * x))
+
+
+def cpx_table(name, phases):
+    lines = ['static const kiss_fft_cpx %s[%d] = {' % (name, len(phases))]
+    for i in range(0, len(phases), 4):
+        row = ['{ %d, %d }' % (fixed(math.cos(ph)), fixed(math.sin(ph))) for ph in phases[i:i + 4]]
+        lines.append('\t' + ', '.join(row) + ',')
+    lines.append('};')
+    return '\n'.join(lines)
+
+
+def plan(nfft):
+    ncfft = nfft // 2
+    twiddles = [-2 * math.pi * i / ncfft for i in range(ncfft)]
+    super_twiddles = [-math.pi * (float(i + 1) / ncfft + .5) for i in range(ncfft // 2)]
+    factors = factor(ncfft)
+    stages = schedule(factors)
+    return '\n'.join([
+        cpx_table('kiss_fft_plan_twiddles_%d' % nfft, twiddles),
+        cpx_table('kiss_fft_plan_super_twiddles_%d' % nfft, super_twiddles),
+        '#ifdef KISS_FFT_ITERATIVE',
+        int_table('unsigned short', 'kiss_fft_plan_swaps_%d' % nfft, swaps(factors)),
+        '#endif',
+        'static struct kiss_fft_state kiss_fft_plan_substate_%d = {' % nfft,
+        '\t.nfft = %d,' % ncfft,
+        '\t.inverse = 0,',
+        '\t.factors = { %s },' % ', '.join(str(f) for f in factors),
+        '#ifdef KISS_FFT_ITERATIVE',
+        '\t.nstages = %d,' % len(stages),
+        '\t.stages = { %s },' % ', '.join('{ %d, %d, %d }' % st for st in stages),
+        '\t.swaps = kiss_fft_plan_swaps_%d,' % nfft,
+        '#endif',
+        '\t.twiddles = kiss_fft_plan_twiddles_%d,' % nfft,
+        '};',
+        '// forward transforms need no tmpbuf',
+        'static struct kiss_fftr_state kiss_fft_plan_%d = {' % nfft,
+        '\t.substate = &kiss_fft_plan_substate_%d,' % nfft,
+        '\t.super_twiddles = kiss_fft_plan_super_twiddles_%d,' % nfft,
+        '};',
+    ])
+
+
+def generate(sizes):
+    out = [
+        '// generated by tools/gen_fft_plan.py %s, do not edit' % ' '.join(str(n) for n in sizes),
+        '// static forward plans for kiss_fftr_alloc, included by kiss_fftr.c only',
+        '',
+    ]
+    for nfft in sizes:
+        out += [plan(nfft), '']
+    out.append('static const kiss_fftr_cfg kiss_fft_plans[] = { %s };'
+               % ', '.join('&kiss_fft_plan_%d' % n for n in sizes))
+    out.append('#define KISS_FFT_NUM_PLANS %d' % len(sizes))
+    return '\n'.join(out) + '\n'
+
+
+def generate_sizes(sizes):
+    return '\n'.join([
+        '// generated by tools/gen_fft_plan.py %s, do not edit' % ' '.join(str(n) for n in sizes),
+        '// sizes of the static plans in kiss_fft_plan.h, kiss_fftr_alloc returns NULL for any other',
+        '#pragma once',
+        '#define KISS_FFT_HAS_PLAN(nfft) (%s)' % ' || '.join('(nfft) == %d' % n for n in sizes),
+    ]) + '\n'
+
+
+def main(args):
+    sizes = [int(a) for a in args] or DEFAULT_SIZES
+    for n in sizes:
+        if n & 1:
+            sys.exit('nfft must be even: %d' % n)
+    src = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'src')
+    with open(os.path.join(src, 'kiss_fft_plan.h'), 'w') as f:
+        f.write(generate(sizes))
+    with open(os.path.join(src, 'kiss_fft_plan_sizes.h'), 'w') as f:
+        f.write(generate_sizes(sizes))
+
+
+if __name__ == '__main__':
+    main(sys.argv[1:])